@@ -21,14 +21,9 @@ struct LegacyRandomAccessIterator
     typedef typename Iter::reference reference;
     typedef std::random_access_iterator_tag iterator_category;
 
+    // 複製和析構用編譯器生成的版本，保持可平凡複製，按值傳遞時放在寄存器裏
     LegacyRandomAccessIterator() {}
 
-    LegacyRandomAccessIterator(const LegacyRandomAccessIterator& other)
-    : m_iter(other.m_iter)
-    {}
-
-    ~LegacyRandomAccessIterator() {}
-
     LegacyRandomAccessIterator(pointer ptr) : m_iter(ptr) {}
 
     LegacyRandomAccessIterator& operator=(const pointer ptr)
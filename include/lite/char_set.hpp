@@ -0,0 +1,476 @@
+#pragma once
+#include <cstddef> // std::size_t
+#include <string>  // std::char_traits
+#include "macro.hpp"
+#include "simd.hpp"
+
+namespace lite
+{
+    template <typename CharT, typename Traits>
+    class basic_string_view;
+
+    namespace simd
+    {
+        // 小集合：每個集合字符廣播成一個向量，每塊逐個比較後相或。只需要SSE2，任意元素寬度
+        template <typename T>
+        struct small_set
+        {
+            typedef std::size_t size_type;
+            typedef std::char_traits<T> traits;
+
+            static const size_type max_size = 16;
+
+            template <bool In>
+            static const T* find_first(const T* p, size_type n, const T* s, size_type m)
+            {
+#if defined(LITE_SSE2)
+                typedef lane<sizeof(T)> L;
+#  if defined(LITE_AVX2)
+                {
+                    const size_type step = 32 / sizeof(T);
+                    __m256i set[max_size];
+                    for (size_type k = 0; k < m; ++k) set[k] = L::set1_256(static_cast<typename L::type>(s[k]));
+                    for (; n >= step; n -= step, p += step)
+                    {
+                        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+                        __m256i hit = _mm256_setzero_si256();
+                        for (size_type k = 0; k < m; ++k) hit = _mm256_or_si256(hit, L::cmpeq(x, set[k]));
+                        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(hit));
+                        if (!In) mask = ~mask;
+                        if (mask != 0) return p + ctz(mask) / sizeof(T);
+                    }
+                }
+#  endif
+                {
+                    const size_type step = 16 / sizeof(T);
+                    __m128i set[max_size];
+                    for (size_type k = 0; k < m; ++k) set[k] = L::set1(static_cast<typename L::type>(s[k]));
+                    for (; n >= step; n -= step, p += step)
+                    {
+                        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+                        __m128i hit = _mm_setzero_si128();
+                        for (size_type k = 0; k < m; ++k) hit = _mm_or_si128(hit, L::cmpeq(x, set[k]));
+                        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(hit));
+                        if (!In) mask ^= 0xFFFFu;
+                        if (mask != 0) return p + ctz(mask) / sizeof(T);
+                    }
+                }
+#endif
+                for (const T* e = p + n; p != e; ++p)
+                {
+                    if ((traits::find(s, m, *p) != NULLPTR) == In) return p;
+                }
+                return NULLPTR;
+            }
+
+            template <bool In>
+            static const T* find_last(const T* p, size_type n, const T* s, size_type m)
+            {
+#if defined(LITE_SSE2)
+                typedef lane<sizeof(T)> L;
+#  if defined(LITE_AVX2)
+                {
+                    const size_type step = 32 / sizeof(T);
+                    __m256i set[max_size];
+                    for (size_type k = 0; k < m; ++k) set[k] = L::set1_256(static_cast<typename L::type>(s[k]));
+                    while (n >= step)
+                    {
+                        n -= step;
+                        __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + n));
+                        __m256i hit = _mm256_setzero_si256();
+                        for (size_type k = 0; k < m; ++k) hit = _mm256_or_si256(hit, L::cmpeq(x, set[k]));
+                        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(hit));
+                        if (!In) mask = ~mask;
+                        if (mask != 0) return p + n + bsr(mask) / sizeof(T);
+                    }
+                }
+#  endif
+                {
+                    const size_type step = 16 / sizeof(T);
+                    __m128i set[max_size];
+                    for (size_type k = 0; k < m; ++k) set[k] = L::set1(static_cast<typename L::type>(s[k]));
+                    while (n >= step)
+                    {
+                        n -= step;
+                        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + n));
+                        __m128i hit = _mm_setzero_si128();
+                        for (size_type k = 0; k < m; ++k) hit = _mm_or_si128(hit, L::cmpeq(x, set[k]));
+                        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(hit));
+                        if (!In) mask ^= 0xFFFFu;
+                        if (mask != 0) return p + n + bsr(mask) / sizeof(T);
+                    }
+                }
+#endif
+                while (n > 0)
+                {
+                    --n;
+                    if ((traits::find(s, m, p[n]) != NULLPTR) == In) return p + n;
+                }
+                return NULLPTR;
+            }
+        };
+    }
+
+    // char的字符集合：256位的位圖，構造一次後可反復用於find_first_of等查找。
+    // 集合中的字節只涉及不超過8種高4位時（任意不超過8個字節的集合，以及常見的分隔符集合），
+    // 另建一對按低4位、高4位索引的表，用SSSE3/AVX2的pshufb每次分類16/32個字節。
+    // 沒有SSSE3或高4位超過8種時，不超過16個字符的集合用simd::small_set逐個廣播比較。
+    class char_set
+    {
+    public:
+        typedef std::size_t size_type;
+
+        char_set()
+        {
+            _clear();
+        }
+
+        explicit char_set(const char* s)
+        {
+            _clear();
+            insert(s, std::char_traits<char>::length(s));
+        }
+
+        char_set(const char* s, size_type count)
+        {
+            _clear();
+            insert(s, count);
+        }
+
+        // 定義在string_view.hpp
+        explicit char_set(basic_string_view<char, std::char_traits<char> > s);
+
+        void insert(char c)
+        {
+            unsigned char u = static_cast<unsigned char>(c);
+            if (contains(c)) return;
+
+            m_bits[u >> 5] |= 1u << (u & 31);
+            if (m_size < simd::small_set<char>::max_size) m_members[m_size] = c;
+            ++m_size;
+
+            unsigned char& hi = m_hi[u >> 4];
+            if (hi == 0)
+            {
+                if (m_hi_used == 8)
+                {
+                    m_nibble = false;
+                    return;
+                }
+                hi = static_cast<unsigned char>(1u << m_hi_used++);
+            }
+            m_lo[u & 15] |= hi;
+        }
+
+        void insert(const char* s, size_type count)
+        {
+            for (size_type i = 0; i < count; ++i)
+            {
+                insert(s[i]);
+            }
+        }
+
+        bool contains(char c) const
+        {
+            unsigned char u = static_cast<unsigned char>(c);
+            return ((m_bits[u >> 5] >> (u & 31)) & 1u) != 0;
+        }
+
+        // 不同字符的個數
+        size_type size() const
+        {
+            return m_size;
+        }
+
+        bool empty() const
+        {
+            return m_size == 0;
+        }
+
+        // 在[p, p + n)中找第一個屬於（不屬於）集合的字符，找不到返回NULLPTR
+        const char* find_first(const char* p, size_type n) const
+        {
+            return _find_first<true>(p, n);
+        }
+
+        const char* find_first_not(const char* p, size_type n) const
+        {
+            return _find_first<false>(p, n);
+        }
+
+        // 在[p, p + n)中找最後一個屬於（不屬於）集合的字符，找不到返回NULLPTR
+        const char* find_last(const char* p, size_type n) const
+        {
+            return _find_last<true>(p, n);
+        }
+
+        const char* find_last_not(const char* p, size_type n) const
+        {
+            return _find_last<false>(p, n);
+        }
+
+    private:
+        void _clear()
+        {
+            for (int i = 0; i < 8; ++i)
+            {
+                m_bits[i] = 0;
+            }
+            for (int i = 0; i < 16; ++i)
+            {
+                m_lo[i] = 0;
+                m_hi[i] = 0;
+            }
+            m_size = 0;
+            m_hi_used = 0;
+            m_nibble = true;
+        }
+
+#if defined(LITE_SSSE3)
+        // 返回16個字節中屬於集合的位掩碼
+        static unsigned _classify(__m128i x, __m128i lo, __m128i hi)
+        {
+            const __m128i low4 = _mm_set1_epi8(0x0F);
+            __m128i l = _mm_shuffle_epi8(lo, _mm_and_si128(x, low4));
+            __m128i h = _mm_shuffle_epi8(hi, _mm_and_si128(_mm_srli_epi16(x, 4), low4));
+            __m128i none = _mm_cmpeq_epi8(_mm_and_si128(l, h), _mm_setzero_si128());
+            return ~static_cast<unsigned>(_mm_movemask_epi8(none)) & 0xFFFFu;
+        }
+#endif
+
+#if defined(LITE_AVX2)
+        static unsigned _classify(__m256i x, __m256i lo, __m256i hi)
+        {
+            const __m256i low4 = _mm256_set1_epi8(0x0F);
+            __m256i l = _mm256_shuffle_epi8(lo, _mm256_and_si256(x, low4));
+            __m256i h = _mm256_shuffle_epi8(hi, _mm256_and_si256(_mm256_srli_epi16(x, 4), low4));
+            __m256i none = _mm256_cmpeq_epi8(_mm256_and_si256(l, h), _mm256_setzero_si256());
+            return ~static_cast<unsigned>(_mm256_movemask_epi8(none));
+        }
+#endif
+
+        template <bool In>
+        const char* _find_first(const char* p, size_type n) const
+        {
+#if defined(LITE_SSSE3)
+            if (m_nibble)
+            {
+                const __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(m_lo));
+                const __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(m_hi));
+#  if defined(LITE_AVX2)
+                const __m256i lo2 = _mm256_broadcastsi128_si256(lo);
+                const __m256i hi2 = _mm256_broadcastsi128_si256(hi);
+                for (; n >= 32; n -= 32, p += 32)
+                {
+                    unsigned mask = _classify(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)), lo2, hi2);
+                    if (!In) mask = ~mask;
+                    if (mask != 0) return p + simd::ctz(mask);
+                }
+#  endif
+                for (; n >= 16; n -= 16, p += 16)
+                {
+                    unsigned mask = _classify(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)), lo, hi);
+                    if (!In) mask ^= 0xFFFFu;
+                    if (mask != 0) return p + simd::ctz(mask);
+                }
+                return _scan_first<In>(p, n);
+            }
+#endif
+            if (m_size <= simd::small_set<char>::max_size)
+            {
+                return simd::small_set<char>::find_first<In>(p, n, m_members, m_size);
+            }
+            return _scan_first<In>(p, n);
+        }
+
+        template <bool In>
+        const char* _find_last(const char* p, size_type n) const
+        {
+#if defined(LITE_SSSE3)
+            if (m_nibble)
+            {
+                const __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(m_lo));
+                const __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(m_hi));
+#  if defined(LITE_AVX2)
+                const __m256i lo2 = _mm256_broadcastsi128_si256(lo);
+                const __m256i hi2 = _mm256_broadcastsi128_si256(hi);
+                while (n >= 32)
+                {
+                    n -= 32;
+                    unsigned mask = _classify(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + n)), lo2, hi2);
+                    if (!In) mask = ~mask;
+                    if (mask != 0) return p + n + simd::bsr(mask);
+                }
+#  endif
+                while (n >= 16)
+                {
+                    n -= 16;
+                    unsigned mask = _classify(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + n)), lo, hi);
+                    if (!In) mask ^= 0xFFFFu;
+                    if (mask != 0) return p + n + simd::bsr(mask);
+                }
+                return _scan_last<In>(p, n);
+            }
+#endif
+            if (m_size <= simd::small_set<char>::max_size)
+            {
+                return simd::small_set<char>::find_last<In>(p, n, m_members, m_size);
+            }
+            return _scan_last<In>(p, n);
+        }
+
+        // 逐字節查位圖
+        template <bool In>
+        const char* _scan_first(const char* p, size_type n) const
+        {
+            for (const char* e = p + n; p != e; ++p)
+            {
+                if (contains(*p) == In) return p;
+            }
+            return NULLPTR;
+        }
+
+        template <bool In>
+        const char* _scan_last(const char* p, size_type n) const
+        {
+            while (n > 0)
+            {
+                --n;
+                if (contains(p[n]) == In) return p + n;
+            }
+            return NULLPTR;
+        }
+
+        unsigned m_bits[8];
+        char m_members[16]; // 前16個不同的字符，m_size不超過16時有效
+        unsigned char m_lo[16];
+        unsigned char m_hi[16];
+        size_type m_size;
+        unsigned m_hi_used;
+        bool m_nibble;
+    };
+
+    // 字符集合查找。char配std::char_traits時用char_set，
+    // 其他情況對每個字符調用Traits::find在集合裏查找。
+    template <typename CharT, typename Traits>
+    struct char_set_scan
+    {
+        typedef std::size_t size_type;
+
+        template <bool In>
+        static const CharT* find_first(const CharT* p, size_type n, const CharT* s, size_type m)
+        {
+            for (const CharT* e = p + n; p != e; ++p)
+            {
+                if ((Traits::find(s, m, *p) != NULLPTR) == In) return p;
+            }
+            return NULLPTR;
+        }
+
+        template <bool In>
+        static const CharT* find_last(const CharT* p, size_type n, const CharT* s, size_type m)
+        {
+            while (n > 0)
+            {
+                --n;
+                if ((Traits::find(s, m, p[n]) != NULLPTR) == In) return p + n;
+            }
+            return NULLPTR;
+        }
+    };
+
+    // 寬字符配std::char_traits：不超過16個字符的集合走simd::small_set，
+    // 更大的集合用256位的位圖判斷小於256的字符，其餘在集合裏順序查找
+    template <typename CharT>
+    struct char_set_scan<CharT, std::char_traits<CharT> >
+    {
+        typedef std::size_t size_type;
+        typedef std::char_traits<CharT> traits;
+
+        template <bool In>
+        static const CharT* find_first(const CharT* p, size_type n, const CharT* s, size_type m)
+        {
+            if (In && m == 1) return char_scan<CharT, traits>::find(p, n, s[0]);
+            if (m <= simd::small_set<CharT>::max_size) return simd::small_set<CharT>::template find_first<In>(p, n, s, m);
+
+            const _bitmap set(s, m);
+            for (const CharT* e = p + n; p != e; ++p)
+            {
+                if (set.contains(*p) == In) return p;
+            }
+            return NULLPTR;
+        }
+
+        template <bool In>
+        static const CharT* find_last(const CharT* p, size_type n, const CharT* s, size_type m)
+        {
+            if (In && m == 1) return char_scan<CharT, traits>::rfind(p, n, s[0]);
+            if (m <= simd::small_set<CharT>::max_size) return simd::small_set<CharT>::template find_last<In>(p, n, s, m);
+
+            const _bitmap set(s, m);
+            while (n > 0)
+            {
+                --n;
+                if (set.contains(p[n]) == In) return p + n;
+            }
+            return NULLPTR;
+        }
+
+    private:
+        // 小於256的字符查位圖，其餘在集合裏查找
+        struct _bitmap
+        {
+            _bitmap(const CharT* s, size_type m) : m_set(s), m_size(m), m_wide(false)
+            {
+                for (int i = 0; i < 8; ++i) m_bits[i] = 0;
+                for (size_type k = 0; k < m; ++k)
+                {
+                    const unsigned long long c = static_cast<unsigned long long>(s[k]);
+                    if (c < 256) m_bits[c >> 5] |= 1u << (c & 31);
+                    else m_wide = true;
+                }
+            }
+
+            bool contains(CharT ch) const
+            {
+                const unsigned long long c = static_cast<unsigned long long>(ch);
+                if (c < 256) return ((m_bits[c >> 5] >> (c & 31)) & 1u) != 0;
+                return m_wide && traits::find(m_set, m_size, ch) != NULLPTR;
+            }
+
+            const CharT* m_set;
+            size_type m_size;
+            unsigned m_bits[8];
+            bool m_wide;
+        };
+    };
+
+    template <>
+    struct char_set_scan<char, std::char_traits<char> >
+    {
+        typedef std::size_t size_type;
+
+        template <bool In>
+        static const char* find_first(const char* p, size_type n, const char* s, size_type m)
+        {
+            if (In && m == 1) return char_scan<char, std::char_traits<char> >::find(p, n, s[0]);
+#if !defined(LITE_SSSE3)
+            // 沒有pshufb時小集合直接廣播比較，省去建char_set
+            if (m <= simd::small_set<char>::max_size) return simd::small_set<char>::find_first<In>(p, n, s, m);
+#endif
+            char_set set(s, m);
+            return In ? set.find_first(p, n) : set.find_first_not(p, n);
+        }
+
+        template <bool In>
+        static const char* find_last(const char* p, size_type n, const char* s, size_type m)
+        {
+            if (In && m == 1) return char_scan<char, std::char_traits<char> >::rfind(p, n, s[0]);
+#if !defined(LITE_SSSE3)
+            if (m <= simd::small_set<char>::max_size) return simd::small_set<char>::find_last<In>(p, n, s, m);
+#endif
+            char_set set(s, m);
+            return In ? set.find_last(p, n) : set.find_last_not(p, n);
+        }
+    };
+}
@@ -0,0 +1,236 @@
+#pragma once
+#include <cerrno>    // errno, EINTR
+#include <cstddef>   // std::size_t
+#include <cstdio>    // std::FILE, std::fread, std::ferror
+#include <cstring>   // std::memcpy, std::strerror
+#include <istream>   // std::istream
+#include <stdexcept> // std::length_error, std::runtime_error
+#include <string>    // std::string
+#include <vector>    // std::vector
+#include "macro.hpp"
+#include "simd.hpp"
+#include "string_view.hpp"
+
+#if defined(_WIN32)
+#  include <io.h> // _read
+#else
+#  include <unistd.h> // read
+#endif
+
+namespace lite
+{
+    // 數據源：operator()(buffer, size)最多讀size字節，返回讀到的字節數，0表示結束，出錯拋異常
+
+    // 文件描述符（管道、套接字）
+    struct fd_source
+    {
+        explicit fd_source(int fd) : m_fd(fd) {}
+
+        std::size_t operator()(char* buffer, std::size_t size)
+        {
+            for (;;)
+            {
+#if defined(_WIN32)
+                int n = ::_read(m_fd, buffer, static_cast<unsigned>(size > 0x7FFFFFFF ? 0x7FFFFFFF : size));
+#else
+                ::ssize_t n = ::read(m_fd, buffer, size);
+#endif
+                if (n >= 0) return static_cast<std::size_t>(n);
+                if (errno != EINTR) throw std::runtime_error(std::string("lite::fd_source: ") + std::strerror(errno));
+            }
+        }
+
+    private:
+        int m_fd;
+    };
+
+    struct stdio_source
+    {
+        explicit stdio_source(std::FILE* file) : m_file(file) {}
+
+        std::size_t operator()(char* buffer, std::size_t size)
+        {
+            std::size_t n = std::fread(buffer, 1, size, m_file);
+            if (n == 0 && std::ferror(m_file)) throw std::runtime_error("lite::stdio_source: read error");
+            return n;
+        }
+
+    private:
+        std::FILE* m_file;
+    };
+
+    struct istream_source
+    {
+        explicit istream_source(std::istream& in) : m_in(&in) {}
+
+        std::size_t operator()(char* buffer, std::size_t size)
+        {
+            m_in->read(buffer, static_cast<std::streamsize>(size));
+            if (m_in->bad()) throw std::runtime_error("lite::istream_source: read error");
+            return static_cast<std::size_t>(m_in->gcount());
+        }
+
+    private:
+        std::istream* m_in;
+    };
+
+    // 從不能映射的數據源（管道、套接字、流）按塊讀取，產出以分隔符結尾的完整記錄。
+    // 兩個緩衝區輪流使用，每個大小固定爲chunk_size + max_record：跨塊的半條記錄在換緩衝區時
+    // 一次性移到另一個緩衝區開頭，之後接着讀下一塊，記錄本身不再逐條複製。
+    // 返回的視圖在緩衝區再換一次之前有效，即處理當前塊時上一塊的視圖仍然可用。
+    // 單條記錄超過max_record時拋出std::length_error，所以內存佔用有上界。
+    template <typename Source>
+    class chunked_reader
+    {
+    public:
+        typedef std::size_t size_type;
+
+        static const size_type default_chunk_size = 1 << 20;
+
+        // max_record爲0時取chunk_size
+        explicit chunked_reader(Source source, size_type chunk_size = default_chunk_size, char delimiter = '\n', size_type max_record = 0)
+            : m_source(source),
+              m_chunk_size(chunk_size == 0 ? size_type(default_chunk_size) : chunk_size),
+              m_max_record(max_record == 0 ? m_chunk_size : max_record),
+              m_delimiter(delimiter),
+              m_current(0), m_pos(0), m_scanned(0), m_size(0), m_bytes_read(0), m_eof(false)
+        {
+            m_buffers[0].resize(m_chunk_size + m_max_record);
+            m_buffers[1].resize(m_chunk_size + m_max_record);
+        }
+
+        // 下一條記錄，不含分隔符。數據源結束時沒有分隔符的最後一段也算一條記錄
+        bool next(string_view& record)
+        {
+            for (;;)
+            {
+                const char* first = _data() + m_pos;
+                const size_type from = _scan_from();
+                const char* p = char_scan<char, std::char_traits<char> >::find(_data() + from, m_size - from, m_delimiter);
+                if (p != NULLPTR)
+                {
+                    record = string_view(first, p - first);
+                    m_pos += p - first + 1;
+                    return true;
+                }
+                m_scanned = m_size;
+                if (m_eof) return _rest(record);
+                _refill();
+            }
+        }
+
+        // 下一批完整的記錄：從當前位置到塊中最後一個分隔符（含），適合再用find、find_first_of整塊掃描
+        bool next_block(string_view& block)
+        {
+            for (;;)
+            {
+                const char* first = _data() + m_pos;
+                const size_type from = _scan_from();
+                const char* p = char_scan<char, std::char_traits<char> >::rfind(_data() + from, m_size - from, m_delimiter);
+                if (p != NULLPTR)
+                {
+                    block = string_view(first, p - first + 1);
+                    m_pos += p - first + 1;
+                    return true;
+                }
+                m_scanned = m_size;
+                if (m_eof) return _rest(block);
+                _refill();
+            }
+        }
+
+        char delimiter() const
+        {
+            return m_delimiter;
+        }
+
+        size_type chunk_size() const
+        {
+            return m_chunk_size;
+        }
+
+        size_type max_record() const
+        {
+            return m_max_record;
+        }
+
+        // 從數據源讀到的字節數
+        size_type bytes_read() const
+        {
+            return m_bytes_read;
+        }
+
+        // 緩衝區佔用的字節數，構造後不再變化
+        size_type memory() const
+        {
+            return m_buffers[0].size() + m_buffers[1].size();
+        }
+
+    private:
+        char* _data()
+        {
+            return &m_buffers[m_current][0];
+        }
+
+        // 跨多次讀取的半條記錄已經掃描過的部分沒有分隔符，從m_scanned接着找
+        size_type _scan_from() const
+        {
+            return m_scanned > m_pos ? m_scanned : m_pos;
+        }
+
+        // 數據源結束後剩下的不完整記錄
+        bool _rest(string_view& out)
+        {
+            if (m_pos == m_size) return false;
+            out = string_view(_data() + m_pos, m_size - m_pos);
+            m_pos = m_size;
+            return true;
+        }
+
+        // 把剩下的半條記錄移到另一個緩衝區開頭，再讀一塊接在後面。
+        // 上次讀到的還沒消耗（短讀或很長的記錄）時直接接着讀，不移動
+        void _refill()
+        {
+            const size_type carry = m_size - m_pos;
+            if (carry > m_max_record)
+            {
+                throw std::length_error("lite::chunked_reader: record longer than max_record");
+            }
+
+            if (m_pos > 0)
+            {
+                const size_type next = 1 - m_current;
+                if (carry > 0) std::memcpy(&m_buffers[next][0], _data() + m_pos, carry);
+                m_current = next;
+                m_pos = 0;
+                m_scanned = carry;
+                m_size = carry;
+            }
+
+            // carry不超過max_record，後面總還有chunk_size字節
+            size_type n = m_source(_data() + m_size, m_chunk_size);
+            m_size += n;
+            m_bytes_read += n;
+            m_eof = n == 0;
+        }
+
+        Source m_source;
+        size_type m_chunk_size;
+        size_type m_max_record;
+        char m_delimiter;
+        std::vector<char> m_buffers[2];
+        size_type m_current; // 正在使用的緩衝區
+        size_type m_pos;     // 未處理數據的起點
+        size_type m_scanned; // [m_pos, m_scanned)中確定沒有分隔符
+        size_type m_size;    // 緩衝區中數據的長度
+        size_type m_bytes_read;
+        bool m_eof;
+    };
+
+    template <typename Source>
+    chunked_reader<Source> make_chunked_reader(Source source, std::size_t chunk_size = chunked_reader<Source>::default_chunk_size,
+                                               char delimiter = '\n', std::size_t max_record = 0)
+    {
+        return chunked_reader<Source>(source, chunk_size, delimiter, max_record);
+    }
+}
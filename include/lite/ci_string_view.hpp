@@ -0,0 +1,331 @@
+#pragma once
+#include <cstddef> // std::size_t
+#include <string>  // std::char_traits
+#include "macro.hpp"
+#include "simd.hpp"
+#include "search.hpp"
+#include "string_view.hpp"
+
+namespace lite
+{
+    // ASCII大小寫轉換，只處理A-Z和a-z，其他字節（包括UTF-8的多字節序列）原樣保留
+    namespace ascii
+    {
+        CONSTEXPR char to_lower(char c) NOEXCEPT
+        {
+            return c >= 'A' && c <= 'Z' ? static_cast<char>(c | 0x20) : c;
+        }
+
+        CONSTEXPR char to_upper(char c) NOEXCEPT
+        {
+            return c >= 'a' && c <= 'z' ? static_cast<char>(c & ~0x20) : c;
+        }
+
+        CONSTEXPR bool is_alpha(char c) NOEXCEPT
+        {
+            return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z');
+        }
+
+        // 一次轉換16/32個字節：有符號比較得到[First, Last]範圍內的字節，再置位或清除0x20。
+        // 0x80以上的字節是負數，不會落入範圍
+        template <char First, char Last, bool Upper>
+        struct case_block
+        {
+#if defined(LITE_SSE2)
+            static __m128i convert(__m128i x)
+            {
+                __m128i in = _mm_and_si128(_mm_cmpgt_epi8(x, _mm_set1_epi8(First - 1)), _mm_cmpgt_epi8(_mm_set1_epi8(Last + 1), x));
+                __m128i bit = _mm_and_si128(in, _mm_set1_epi8(0x20));
+                return Upper ? _mm_xor_si128(x, bit) : _mm_or_si128(x, bit);
+            }
+#endif
+#if defined(LITE_AVX2)
+            static __m256i convert(__m256i x)
+            {
+                __m256i in = _mm256_and_si256(_mm256_cmpgt_epi8(x, _mm256_set1_epi8(First - 1)), _mm256_cmpgt_epi8(_mm256_set1_epi8(Last + 1), x));
+                __m256i bit = _mm256_and_si256(in, _mm256_set1_epi8(0x20));
+                return Upper ? _mm256_xor_si256(x, bit) : _mm256_or_si256(x, bit);
+            }
+#endif
+            static char convert(char c)
+            {
+                return Upper ? to_upper(c) : to_lower(c);
+            }
+
+            static void copy(const char* src, std::size_t n, char* dst)
+            {
+                std::size_t i = 0;
+#if defined(LITE_AVX2)
+                for (; i + 32 <= n; i += 32)
+                {
+                    __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+                    _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), convert(x));
+                }
+#endif
+#if defined(LITE_SSE2)
+                for (; i + 16 <= n; i += 16)
+                {
+                    __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), convert(x));
+                }
+#endif
+                for (; i < n; ++i)
+                {
+                    dst[i] = convert(src[i]);
+                }
+            }
+        };
+
+        typedef case_block<'A', 'Z', false> lower_block;
+        typedef case_block<'a', 'z', true> upper_block;
+
+        // 把src的n個字節轉成小寫（大寫）寫到dst，dst至少n字節，可以等於src
+        inline void to_lower(const char* src, std::size_t n, char* dst)
+        {
+            lower_block::copy(src, n, dst);
+        }
+
+        inline void to_upper(const char* src, std::size_t n, char* dst)
+        {
+            upper_block::copy(src, n, dst);
+        }
+
+        // 返回指向dst中結果的視圖
+        inline string_view to_lower(string_view src, char* dst)
+        {
+            to_lower(src.data(), src.size(), dst);
+            return string_view(dst, src.size());
+        }
+
+        inline string_view to_upper(string_view src, char* dst)
+        {
+            to_upper(src.data(), src.size(), dst);
+            return string_view(dst, src.size());
+        }
+
+        // 忽略大小寫時第一個不同字節的下標，全部相同時返回n
+        inline std::size_t mismatch(const char* a, const char* b, std::size_t n)
+        {
+            std::size_t i = 0;
+#if defined(LITE_AVX2)
+            for (; i + 32 <= n; i += 32)
+            {
+                __m256i x = lower_block::convert(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i)));
+                __m256i y = lower_block::convert(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i)));
+                unsigned mask = ~static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, y)));
+                if (mask != 0) return i + simd::ctz(mask);
+            }
+#endif
+#if defined(LITE_SSE2)
+            for (; i < n && n >= 16; i += 16)
+            {
+                if (i + 16 > n) i = n - 16; // 重疊的最後一塊
+                __m128i x = lower_block::convert(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)));
+                __m128i y = lower_block::convert(_mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i)));
+                unsigned mask = ~static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(x, y))) & 0xFFFF;
+                if (mask != 0) return i + simd::ctz(mask);
+            }
+#endif
+            for (; i < n; ++i)
+            {
+                if (to_lower(a[i]) != to_lower(b[i])) return i;
+            }
+            return n;
+        }
+
+        // 忽略大小寫找字符，找不到返回NULLPTR。不是字母時就是普通的查找
+        inline const char* find(const char* p, std::size_t n, char c)
+        {
+            if (!is_alpha(c)) return simd::scan<char>::find(p, n, c);
+
+            const char lower = to_lower(c);
+            std::size_t i = 0;
+#if defined(LITE_AVX2)
+            const __m256i v32 = _mm256_set1_epi8(lower);
+            for (; i + 32 <= n; i += 32)
+            {
+                __m256i x = lower_block::convert(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i)));
+                unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, v32)));
+                if (mask != 0) return p + i + simd::ctz(mask);
+            }
+#endif
+#if defined(LITE_SSE2)
+            const __m128i v16 = _mm_set1_epi8(lower);
+            for (; i < n && n >= 16; i += 16)
+            {
+                if (i + 16 > n) i = n - 16; // 重疊的最後一塊
+                __m128i x = lower_block::convert(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i)));
+                unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(x, v16)));
+                if (mask != 0) return p + i + simd::ctz(mask);
+            }
+#endif
+            for (; i < n; ++i)
+            {
+                if (to_lower(p[i]) == lower) return p + i;
+            }
+            return NULLPTR;
+        }
+
+        // 忽略大小寫的子串查找（m >= 2）：首尾字符轉小寫後用SIMD過濾候選位置，再校驗中間部分
+        inline const char* search(const char* h, std::size_t n, const char* s, std::size_t m)
+        {
+            if (n < m) return NULLPTR;
+
+            const char first = to_lower(s[0]);
+            const char last = to_lower(s[m - 1]);
+            const std::size_t end = n - m + 1; // 候選起點的個數
+            std::size_t i = 0;
+#if defined(LITE_AVX2)
+            const __m256i f32 = _mm256_set1_epi8(first);
+            const __m256i l32 = _mm256_set1_epi8(last);
+            for (; i + 32 <= end; i += 32)
+            {
+                __m256i a = lower_block::convert(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(h + i)));
+                __m256i b = lower_block::convert(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(h + i + m - 1)));
+                unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(a, f32), _mm256_cmpeq_epi8(b, l32))));
+                for (; mask != 0; mask &= mask - 1)
+                {
+                    const char* p = h + i + simd::ctz(mask);
+                    if (mismatch(p + 1, s + 1, m - 2) == m - 2) return p;
+                }
+            }
+#endif
+#if defined(LITE_SSE2)
+            const __m128i f16 = _mm_set1_epi8(first);
+            const __m128i l16 = _mm_set1_epi8(last);
+            // 最後不足16個候選時退回16個，重疊部分之前已經排除，結果仍是第一個匹配
+            for (; i < end && end >= 16; i += 16)
+            {
+                if (i + 16 > end) i = end - 16;
+                __m128i a = lower_block::convert(_mm_loadu_si128(reinterpret_cast<const __m128i*>(h + i)));
+                __m128i b = lower_block::convert(_mm_loadu_si128(reinterpret_cast<const __m128i*>(h + i + m - 1)));
+                unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(a, f16), _mm_cmpeq_epi8(b, l16))));
+                for (; mask != 0; mask &= mask - 1)
+                {
+                    const char* p = h + i + simd::ctz(mask);
+                    if (mismatch(p + 1, s + 1, m - 2) == m - 2) return p;
+                }
+            }
+#endif
+            for (; i < end; ++i)
+            {
+                if (to_lower(h[i]) == first && to_lower(h[i + m - 1]) == last && mismatch(h + i + 1, s + 1, m - 2) == m - 2)
+                {
+                    return h + i;
+                }
+            }
+            return NULLPTR;
+        }
+    }
+
+    // 忽略ASCII大小寫的字符特性：按小寫比較和排序，compare和find走ascii中的SIMD內核
+    struct ci_char_traits : std::char_traits<char>
+    {
+        static CONSTEXPR bool eq(char a, char b) NOEXCEPT
+        {
+            return ascii::to_lower(a) == ascii::to_lower(b);
+        }
+
+        static CONSTEXPR bool lt(char a, char b) NOEXCEPT
+        {
+            return static_cast<unsigned char>(ascii::to_lower(a)) < static_cast<unsigned char>(ascii::to_lower(b));
+        }
+
+        static CONSTEXPR14 int compare(const char* a, const char* b, std::size_t n)
+        {
+            std::size_t i = 0;
+            if (LITE_IS_CONSTANT_EVALUATED())
+            {
+                while (i < n && eq(a[i], b[i])) ++i;
+            }
+            else
+            {
+                i = ascii::mismatch(a, b, n);
+            }
+            if (i == n) return 0;
+            return lt(a[i], b[i]) ? -1 : 1;
+        }
+
+        static CONSTEXPR14 const char* find(const char* p, std::size_t n, const char& c)
+        {
+            if (LITE_IS_CONSTANT_EVALUATED())
+            {
+                for (std::size_t i = 0; i < n; ++i)
+                {
+                    if (eq(p[i], c)) return p + i;
+                }
+                return NULLPTR;
+            }
+            return ascii::find(p, n, c);
+        }
+    };
+
+    typedef basic_string_view<char, ci_char_traits> ci_string_view;
+
+    template <>
+    struct char_compare<char, ci_char_traits>
+    {
+        static bool equal(const char* a, const char* b, std::size_t n)
+        {
+            return ascii::mismatch(a, b, n) == n;
+        }
+
+        static std::size_t mismatch(const char* a, const char* b, std::size_t n)
+        {
+            return ascii::mismatch(a, b, n);
+        }
+
+        static int compare(const char* a, const char* b, std::size_t n)
+        {
+            return ci_char_traits::compare(a, b, n);
+        }
+    };
+
+    // 短模式串用忽略大小寫的首尾字符過濾，長模式串走Two-Way
+    template <>
+    struct string_search<char, ci_char_traits>
+    {
+        typedef std::size_t size_type;
+
+        static const size_type short_needle = 32;
+
+        static const char* find(const char* h, size_type n, const char* s, size_type m)
+        {
+            if (m == 0) return h;
+            if (n < m) return NULLPTR;
+            if (m <= short_needle || n - m < 4 * short_needle) return _find_short(h, n, s, m);
+            return two_way<char, ci_char_traits>(s, m).find(h, n);
+        }
+
+        // searcher對短模式串直接調用它，m不爲0且n >= m
+        static const char* _find_short(const char* h, size_type n, const char* s, size_type m)
+        {
+            if (m == 1) return ascii::find(h, n, s[0]);
+            return ascii::search(h, n, s, m);
+        }
+    };
+
+    // 以下用於普通的string_view，不需要先複製成小寫
+
+    inline bool iequals(string_view a, string_view b)
+    {
+        return a.size() == b.size() && ascii::mismatch(a.data(), b.data(), a.size()) == a.size();
+    }
+
+    inline bool istarts_with(string_view s, string_view prefix)
+    {
+        return s.size() >= prefix.size() && ascii::mismatch(s.data(), prefix.data(), prefix.size()) == prefix.size();
+    }
+
+    inline bool iends_with(string_view s, string_view suffix)
+    {
+        return s.size() >= suffix.size()
+            && ascii::mismatch(s.data() + s.size() - suffix.size(), suffix.data(), suffix.size()) == suffix.size();
+    }
+
+    // 忽略大小寫查找子串，返回下標，找不到返回string_view::_npos()
+    inline std::size_t ifind(string_view s, string_view needle, std::size_t pos = 0)
+    {
+        return ci_string_view(s.data(), s.size()).find(ci_string_view(needle.data(), needle.size()), pos);
+    }
+}
@@ -0,0 +1,374 @@
+#pragma once
+#include <cstddef>  // std::size_t
+#include <cstring>  // std::memcpy
+#include <iterator> // std::forward_iterator_tag
+#include <string>   // std::string
+#include <utility>  // std::pair
+#include <vector>   // std::vector
+#include "macro.hpp"
+#include "simd.hpp"
+#include "string_view.hpp"
+#include "hash.hpp"
+
+namespace lite
+{
+    // 鍵的存儲。InlineSize > 0時，不超過InlineSize字節的鍵複製到槽裏，不再引用外部內存。
+    template <std::size_t InlineSize>
+    struct view_map_key
+    {
+        string_view get() const
+        {
+            return m_inline ? string_view(m_buffer, m_size) : string_view(m_data, m_size);
+        }
+
+        void set(string_view key)
+        {
+            m_size = key.size();
+            m_inline = key.size() <= InlineSize;
+            if (m_inline)
+            {
+                if (!key.empty()) std::memcpy(m_buffer, key.data(), key.size());
+                m_data = NULLPTR;
+            }
+            else
+            {
+                m_data = key.data();
+            }
+        }
+
+    private:
+        const char* m_data;
+        std::size_t m_size;
+        bool m_inline;
+        char m_buffer[InlineSize];
+    };
+
+    template <>
+    struct view_map_key<0>
+    {
+        string_view get() const
+        {
+            return string_view(m_data, m_size);
+        }
+
+        void set(string_view key)
+        {
+            m_data = key.data();
+            m_size = key.size();
+        }
+
+    private:
+        const char* m_data;
+        std::size_t m_size;
+    };
+
+    // 以lite::string_view爲鍵的開放定址散列表（Swiss table）：
+    // 每個槽一個控制字節（空、已刪除或散列值的低7位），16個一組用SSE2一次比較；
+    // 槽內直接存鍵、散列值和V，沒有節點分配。
+    // 鍵只保存視圖，被引用的內存必須比表活得久，除非鍵不超過InlineKey字節（此時複製進槽）。
+    // V需要可默認構造和複製。
+    template < typename V, std::size_t InlineKey = 0, typename Hash = hash<string_view> >
+    class flat_view_map
+    {
+    public:
+        typedef std::size_t size_type;
+        typedef string_view key_type;
+        typedef V mapped_type;
+
+        class value_type
+        {
+        public:
+            key_type key() const { return m_key.get(); }
+
+            V value;
+
+        private:
+            friend class flat_view_map;
+            view_map_key<InlineKey> m_key;
+            size_type m_hash;
+        };
+
+        template <typename Slot, typename Map>
+        class basic_iterator
+        {
+        public:
+            typedef std::forward_iterator_tag iterator_category;
+            typedef Slot value_type;
+            typedef std::ptrdiff_t difference_type;
+            typedef Slot* pointer;
+            typedef Slot& reference;
+
+            basic_iterator() : m_map(NULLPTR), m_index(0) {}
+            basic_iterator(Map* map, size_type index) : m_map(map), m_index(index) { _skip(); }
+
+            // iterator可轉換成const_iterator
+            template <typename S, typename M>
+            basic_iterator(const basic_iterator<S, M>& other) : m_map(other.m_map), m_index(other.m_index) {}
+
+            reference operator*() const { return m_map->m_slots[m_index]; }
+            pointer operator->() const { return &m_map->m_slots[m_index]; }
+
+            basic_iterator& operator++()
+            {
+                ++m_index;
+                _skip();
+                return *this;
+            }
+
+            basic_iterator operator++(int)
+            {
+                basic_iterator temp = *this;
+                ++*this;
+                return temp;
+            }
+
+            bool operator==(const basic_iterator& other) const { return m_index == other.m_index; }
+            bool operator!=(const basic_iterator& other) const { return m_index != other.m_index; }
+
+        private:
+            template <typename S, typename M>
+            friend class basic_iterator;
+
+            void _skip()
+            {
+                while (m_index < m_map->m_ctrl.size() && !_full(m_map->m_ctrl[m_index]))
+                {
+                    ++m_index;
+                }
+            }
+
+            Map* m_map;
+            size_type m_index;
+        };
+
+        typedef basic_iterator<value_type, flat_view_map> iterator;
+        typedef basic_iterator<const value_type, const flat_view_map> const_iterator;
+
+        explicit flat_view_map(const Hash& h = Hash())
+            : m_hash(h), m_size(0), m_deleted(0)
+        {
+        }
+
+        size_type size() const { return m_size; }
+        bool empty() const { return m_size == 0; }
+        size_type capacity() const { return m_ctrl.size(); }
+
+        iterator begin() { return iterator(this, 0); }
+        iterator end() { return iterator(this, m_ctrl.size()); }
+        const_iterator begin() const { return const_iterator(this, 0); }
+        const_iterator end() const { return const_iterator(this, m_ctrl.size()); }
+
+        void clear()
+        {
+            m_ctrl.clear();
+            m_slots.clear();
+            m_size = 0;
+            m_deleted = 0;
+        }
+
+        // 保證能放下n個元素而不再擴容
+        void reserve(size_type n)
+        {
+            size_type cap = group_size;
+            while (cap / 8 * 7 < n)
+            {
+                cap *= 2;
+            }
+            if (cap > m_ctrl.size()) _rehash(cap);
+        }
+
+        // 查找，找不到返回NULLPTR。const char*和std::string只構造視圖，不分配內存
+        V* find(string_view key)
+        {
+            size_type i = _find(key, m_hash(key));
+            return i == npos() ? NULLPTR : &m_slots[i].value;
+        }
+
+        const V* find(string_view key) const
+        {
+            size_type i = _find(key, m_hash(key));
+            return i == npos() ? NULLPTR : &m_slots[i].value;
+        }
+
+        V* find(const char* key) { return find(string_view(key)); }
+        const V* find(const char* key) const { return find(string_view(key)); }
+        V* find(const std::string& key) { return find(string_view(key.data(), key.size())); }
+        const V* find(const std::string& key) const { return find(string_view(key.data(), key.size())); }
+
+        bool contains(string_view key) const { return find(key) != NULLPTR; }
+        bool contains(const char* key) const { return find(key) != NULLPTR; }
+        bool contains(const std::string& key) const { return find(key) != NULLPTR; }
+
+        // 插入，鍵已存在時不覆蓋。返回值的指針和是否新插入
+        std::pair<V*, bool> insert(string_view key, const V& value)
+        {
+            size_type h = m_hash(key);
+            size_type i = _find(key, h);
+            if (i != npos()) return std::pair<V*, bool>(&m_slots[i].value, false);
+
+            i = _insert(key, h);
+            m_slots[i].value = value;
+            return std::pair<V*, bool>(&m_slots[i].value, true);
+        }
+
+        V& operator[](string_view key)
+        {
+            size_type h = m_hash(key);
+            size_type i = _find(key, h);
+            if (i == npos())
+            {
+                i = _insert(key, h);
+                m_slots[i].value = V();
+            }
+            return m_slots[i].value;
+        }
+
+        // 刪除，返回刪除的個數
+        size_type erase(string_view key)
+        {
+            size_type i = _find(key, m_hash(key));
+            if (i == npos()) return 0;
+
+            // 組裏還有空位說明沒有探測序列越過這一組，可以直接置空
+            size_type group = i & ~size_type(group_size - 1);
+            if (_match(group, ctrl_empty) != 0)
+            {
+                m_ctrl[i] = ctrl_empty;
+            }
+            else
+            {
+                m_ctrl[i] = ctrl_deleted;
+                ++m_deleted;
+            }
+            m_slots[i].value = V();
+            --m_size;
+            return 1;
+        }
+
+    private:
+        enum
+        {
+            group_size = 16,
+            ctrl_empty = 0x80,
+            ctrl_deleted = 0xFE
+        };
+
+        static size_type npos() { return size_type(-1); }
+
+        static bool _full(unsigned char c) { return (c & 0x80) == 0; }
+
+        static unsigned char _h2(size_type h) { return static_cast<unsigned char>(h & 0x7F); }
+
+        // 組內控制字節等於c的位掩碼
+        unsigned _match(size_type group, unsigned char c) const
+        {
+            const unsigned char* p = &m_ctrl[group];
+#if defined(LITE_SSE2)
+            __m128i ctrl = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            return static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8(static_cast<char>(c)))));
+#else
+            unsigned mask = 0;
+            for (size_type i = 0; i < group_size; ++i)
+            {
+                if (p[i] == c) mask |= 1u << i;
+            }
+            return mask;
+#endif
+        }
+
+        // 組內空或已刪除的位掩碼
+        unsigned _match_free(size_type group) const
+        {
+            const unsigned char* p = &m_ctrl[group];
+#if defined(LITE_SSE2)
+            __m128i ctrl = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            return static_cast<unsigned>(_mm_movemask_epi8(ctrl));
+#else
+            unsigned mask = 0;
+            for (size_type i = 0; i < group_size; ++i)
+            {
+                if (!_full(p[i])) mask |= 1u << i;
+            }
+            return mask;
+#endif
+        }
+
+        size_type _find(string_view key, size_type h) const
+        {
+            if (m_ctrl.empty()) return npos();
+
+            const size_type groups_mask = m_ctrl.size() / group_size - 1;
+            const unsigned char h2 = _h2(h);
+            size_type g = (h >> 7) & groups_mask;
+            for (size_type step = 1; ; ++step)
+            {
+                size_type group = g * group_size;
+                for (unsigned mask = _match(group, h2); mask != 0; mask &= mask - 1)
+                {
+                    size_type i = group + simd::ctz(mask);
+                    const value_type& slot = m_slots[i];
+                    if (slot.m_hash == h && slot.key() == key) return i;
+                }
+                if (_match(group, ctrl_empty) != 0) return npos();
+                g = (g + step) & groups_mask;
+            }
+        }
+
+        // 鍵不存在時調用，返回新槽的下標
+        size_type _insert(string_view key, size_type h)
+        {
+            // 負載（含已刪除）超過7/8時重建；有效元素不到一半時只清理已刪除的槽，不擴容
+            const size_type cap = m_ctrl.size();
+            if (m_size + m_deleted + 1 > cap / 8 * 7)
+            {
+                _rehash(cap == 0 ? size_type(group_size) : (m_size + 1 > cap / 16 * 7 ? cap * 2 : cap));
+            }
+
+            size_type i = _free_slot(h);
+            if (m_ctrl[i] == ctrl_deleted) --m_deleted;
+            m_ctrl[i] = _h2(h);
+            m_slots[i].m_key.set(key);
+            m_slots[i].m_hash = h;
+            ++m_size;
+            return i;
+        }
+
+        size_type _free_slot(size_type h) const
+        {
+            const size_type groups_mask = m_ctrl.size() / group_size - 1;
+            size_type g = (h >> 7) & groups_mask;
+            for (size_type step = 1; ; ++step)
+            {
+                size_type group = g * group_size;
+                unsigned mask = _match_free(group);
+                if (mask != 0) return group + simd::ctz(mask);
+                g = (g + step) & groups_mask;
+            }
+        }
+
+        void _rehash(size_type cap)
+        {
+            std::vector<unsigned char> ctrl(cap, static_cast<unsigned char>(ctrl_empty));
+            std::vector<value_type> slots(cap);
+            ctrl.swap(m_ctrl);
+            slots.swap(m_slots);
+            m_deleted = 0;
+            for (size_type i = 0; i < ctrl.size(); ++i)
+            {
+                if (!_full(ctrl[i])) continue;
+
+                size_type j = _free_slot(slots[i].m_hash);
+                m_ctrl[j] = ctrl[i];
+                m_slots[j].m_key.set(slots[i].key());
+                m_slots[j].m_hash = slots[i].m_hash;
+                m_slots[j].value = slots[i].value;
+            }
+        }
+
+        Hash m_hash;
+        std::vector<unsigned char> m_ctrl;
+        std::vector<value_type> m_slots;
+        size_type m_size;
+        size_type m_deleted;
+    };
+}
@@ -0,0 +1,210 @@
+#pragma once
+#include <cstddef> // std::size_t
+#include <cstring> // std::memcpy
+#include <string>  // std::char_traits
+#include "macro.hpp"
+#include "simd.hpp"
+#include "string_view.hpp"
+
+#if __cplusplus >= 201103L
+#  include <functional> // std::hash
+#endif
+
+namespace lite
+{
+    // wyhash（final4）：8字節一讀，用64×64→128位乘法混合；不超過16字節的鍵不進循環，
+    // 用兩次重疊的4字節讀取覆蓋整個鍵。
+    namespace wyhash
+    {
+        typedef unsigned long long u64;
+
+        CONSTEXPR14 void mum(u64& a, u64& b)
+        {
+            simd::mul128(a, b);
+        }
+
+        CONSTEXPR14 u64 mix(u64 a, u64 b)
+        {
+            mum(a, b);
+            return a ^ b;
+        }
+
+        CONSTEXPR u64 secret(int i)
+        {
+            return i == 0 ? 0x2d358dccaa6c78a5ull : i == 1 ? 0x8bb84b93962eacc9ull : i == 2 ? 0x4b33a62ed433d4a3ull : 0x4d5a2da51de1aa47ull;
+        }
+
+        // 運行時按字節讀內存
+        struct memory_reader
+        {
+            explicit memory_reader(const void* p) : m_p(static_cast<const unsigned char*>(p)) {}
+
+            u64 r8(std::size_t i) const
+            {
+                u64 v;
+                std::memcpy(&v, m_p + i, 8);
+                return v;
+            }
+
+            u64 r4(std::size_t i) const
+            {
+                unsigned v;
+                std::memcpy(&v, m_p + i, 4);
+                return v;
+            }
+
+            u64 r1(std::size_t i) const
+            {
+                return m_p[i];
+            }
+
+        private:
+            const unsigned char* m_p;
+        };
+
+        // 常量求值時從字符值拼出字節，字節順序與運行時讀內存相同，所以編譯期和運行時的散列一致
+        template <typename CharT>
+        struct constant_reader
+        {
+            CONSTEXPR explicit constant_reader(const CharT* p) : m_p(p) {}
+
+            CONSTEXPR14 u64 r8(std::size_t i) const
+            {
+                u64 v = 0;
+                for (std::size_t k = 0; k < 8; ++k) v |= r1(i + k) << (_little() ? 8 * k : 56 - 8 * k);
+                return v;
+            }
+
+            CONSTEXPR14 u64 r4(std::size_t i) const
+            {
+                u64 v = 0;
+                for (std::size_t k = 0; k < 4; ++k) v |= r1(i + k) << (_little() ? 8 * k : 24 - 8 * k);
+                return v;
+            }
+
+            // 第i個字節
+            CONSTEXPR14 u64 r1(std::size_t i) const
+            {
+                const std::size_t k = i % sizeof(CharT);
+                const std::size_t shift = 8 * (_little() ? k : sizeof(CharT) - 1 - k);
+                return (static_cast<u64>(m_p[i / sizeof(CharT)]) >> shift) & 0xFF;
+            }
+
+        private:
+            static CONSTEXPR bool _little()
+            {
+#if defined(__BYTE_ORDER__) && defined(__ORDER_BIG_ENDIAN__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+                return false;
+#else
+                return true;
+#endif
+            }
+
+            const CharT* m_p;
+        };
+
+        template <typename Reader>
+        CONSTEXPR14 u64 hash(const Reader& r, std::size_t len, u64 seed)
+        {
+            seed ^= mix(seed ^ secret(0), secret(1));
+            u64 a = 0;
+            u64 b = 0;
+            if (len <= 16)
+            {
+                if (len >= 4)
+                {
+                    std::size_t d = (len >> 3) << 2;
+                    a = (r.r4(0) << 32) | r.r4(d);
+                    b = (r.r4(len - 4) << 32) | r.r4(len - 4 - d);
+                }
+                else if (len > 0)
+                {
+                    // 1到3個字節
+                    a = (r.r1(0) << 16) | (r.r1(len >> 1) << 8) | r.r1(len - 1);
+                }
+            }
+            else
+            {
+                std::size_t p = 0;
+                std::size_t i = len;
+                if (i > 48)
+                {
+                    u64 see1 = seed;
+                    u64 see2 = seed;
+                    do
+                    {
+                        seed = mix(r.r8(p) ^ secret(1), r.r8(p + 8) ^ seed);
+                        see1 = mix(r.r8(p + 16) ^ secret(2), r.r8(p + 24) ^ see1);
+                        see2 = mix(r.r8(p + 32) ^ secret(3), r.r8(p + 40) ^ see2);
+                        p += 48;
+                        i -= 48;
+                    } while (i > 48);
+                    seed ^= see1 ^ see2;
+                }
+                while (i > 16)
+                {
+                    seed = mix(r.r8(p) ^ secret(1), r.r8(p + 8) ^ seed);
+                    i -= 16;
+                    p += 16;
+                }
+                a = r.r8(p + i - 16);
+                b = r.r8(p + i - 8);
+            }
+            a ^= secret(1);
+            b ^= seed;
+            mum(a, b);
+            return mix(a ^ secret(0) ^ len, b ^ secret(1));
+        }
+
+        inline u64 hash(const void* key, std::size_t len, u64 seed)
+        {
+            return hash(memory_reader(key), len, seed);
+        }
+    }
+
+    // 64位散列，結果與CharT的字節表示有關
+    inline unsigned long long hash_bytes(const void* data, std::size_t size, unsigned long long seed = 0)
+    {
+        return wyhash::hash(data, size, seed);
+    }
+
+    template <typename T>
+    struct hash;
+
+    // 只對std::char_traits提供：自定義Traits的eq可能讓字節不同的串相等
+    template <typename CharT>
+    struct hash< basic_string_view<CharT, std::char_traits<CharT> > >
+    {
+        typedef basic_string_view<CharT, std::char_traits<CharT> > argument_type;
+        typedef std::size_t result_type;
+
+        CONSTEXPR hash() : m_seed(0) {}
+
+        // 帶種子的散列，不同種子得到互不相關的散列函數
+        CONSTEXPR explicit hash(unsigned long long seed) : m_seed(seed) {}
+
+        // 可以在常量表達式中使用，編譯期建的表與運行時的查找得到相同的散列
+        CONSTEXPR14 std::size_t operator()(argument_type v) const
+        {
+            if (LITE_IS_CONSTANT_EVALUATED())
+            {
+                return static_cast<std::size_t>(wyhash::hash(wyhash::constant_reader<CharT>(v.data()), v.size() * sizeof(CharT), m_seed));
+            }
+            return static_cast<std::size_t>(hash_bytes(v.data(), v.size() * sizeof(CharT), m_seed));
+        }
+
+    private:
+        unsigned long long m_seed;
+    };
+}
+
+#if __cplusplus >= 201103L
+namespace std
+{
+    template <typename CharT>
+    struct hash< lite::basic_string_view<CharT, std::char_traits<CharT> > >
+        : lite::hash< lite::basic_string_view<CharT, std::char_traits<CharT> > >
+    {
+    };
+}
+#endif
@@ -30,3 +30,45 @@
 #    define NODISCARD
 #  endif
 #endif
+
+// C++14起constexpr函數可以有多條語句
+#ifndef CONSTEXPR14
+#  if __cplusplus >= 201402L
+#    define CONSTEXPR14 constexpr
+#  else
+#    define CONSTEXPR14 inline
+#  endif
+#endif
+
+// 是否在常量求值中（std::is_constant_evaluated）。編譯器不支持時總是false，
+// 這時只能在編譯期使用本身是constexpr的Traits函數（C++17起的std::char_traits）
+#ifndef LITE_IS_CONSTANT_EVALUATED
+#  if defined(__has_builtin)
+#    if __has_builtin(__builtin_is_constant_evaluated)
+#      define LITE_IS_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#    endif
+#  endif
+#  if !defined(LITE_IS_CONSTANT_EVALUATED) && \
+      ((defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 9) || (defined(_MSC_VER) && _MSC_VER >= 1925))
+#    define LITE_IS_CONSTANT_EVALUATED() __builtin_is_constant_evaluated()
+#  endif
+#  ifndef LITE_IS_CONSTANT_EVALUATED
+#    define LITE_IS_CONSTANT_EVALUATED() false
+#  endif
+#endif
+
+// C++20起basic_string_view的迭代器是const CharT*：標準庫把它當作連續迭代器（contiguous_iterator），
+// std::find、std::copy、std::equal等可以走memchr/memmove/memcmp。定義爲0時用LegacyRandomAccessIterator
+#ifndef LITE_CONTIGUOUS_ITERATOR
+#  if __cplusplus >= 202002L
+#    define LITE_CONTIGUOUS_ITERATOR 1
+#  else
+#    define LITE_CONTIGUOUS_ITERATOR 0
+#  endif
+#endif
+
+// 定義爲1時basic_string_view在各成員函數裏記錄調用次數、掃描的字節數和長度分佈，
+// 用lite::stats::dump()查看（見stats.hpp）。默認爲0，這時不生成任何記錄代碼。需要C++11
+#ifndef LITE_STATS
+#  define LITE_STATS 0
+#endif
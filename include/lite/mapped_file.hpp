@@ -0,0 +1,281 @@
+#pragma once
+#include <cerrno>    // errno
+#include <cstddef>   // std::size_t
+#include <cstring>   // std::strerror
+#include <stdexcept> // std::runtime_error
+#include <string>    // std::string
+#include <utility>   // std::swap
+#include "macro.hpp"
+#include "string_view.hpp"
+#include "split_view.hpp"
+
+#if defined(_WIN32)
+#  ifndef NOMINMAX
+#    define NOMINMAX
+#  endif
+#  include <windows.h>
+#else
+#  include <fcntl.h>    // open
+#  include <sys/mman.h> // mmap, madvise
+#  include <sys/stat.h> // fstat
+#  include <unistd.h>   // close
+#endif
+
+namespace lite
+{
+    // 只讀映射整個文件，view()返回覆蓋整個文件的視圖，不把文件讀進自己的緩衝區。
+    // 64位平臺上可以映射超過4GiB的文件。打開失敗拋出std::runtime_error。
+    // 視圖在close()或析構之前有效。不能複製，C++11起可以移動。
+    class mapped_file
+    {
+    public:
+        typedef std::size_t size_type;
+
+        // 訪問模式的提示，可以按位或。只是建議，系統不支持時忽略
+        enum hint
+        {
+            no_hint = 0,
+            sequential = 1, // 順序讀，加大預讀（MADV_SEQUENTIAL）
+            willneed = 2,   // 馬上要用，提前開始讀（MADV_WILLNEED）
+            huge_pages = 4, // 請求透明大頁，減少TLB缺失（MADV_HUGEPAGE）
+            populate = 8    // 映射時就讀入所有頁（MAP_POPULATE）
+        };
+
+        mapped_file()
+            : m_data(NULLPTR), m_size(0), m_open(false)
+        {
+            _reset_handles();
+        }
+
+        explicit mapped_file(const char* path, unsigned hints = sequential | willneed)
+            : m_data(NULLPTR), m_size(0), m_open(false)
+        {
+            _reset_handles();
+            open(path, hints);
+        }
+
+        explicit mapped_file(const std::string& path, unsigned hints = sequential | willneed)
+            : m_data(NULLPTR), m_size(0), m_open(false)
+        {
+            _reset_handles();
+            open(path.c_str(), hints);
+        }
+
+        ~mapped_file()
+        {
+            close();
+        }
+
+#if __cplusplus >= 201103L
+        mapped_file(mapped_file&& other) NOEXCEPT
+            : m_data(NULLPTR), m_size(0), m_open(false)
+        {
+            _reset_handles();
+            swap(other);
+        }
+
+        mapped_file& operator=(mapped_file&& other) NOEXCEPT
+        {
+            if (this != &other)
+            {
+                close();
+                swap(other);
+            }
+            return *this;
+        }
+#endif
+
+        void swap(mapped_file& other) NOEXCEPT
+        {
+            std::swap(m_data, other.m_data);
+            std::swap(m_size, other.m_size);
+            std::swap(m_open, other.m_open);
+#if defined(_WIN32)
+            std::swap(m_file, other.m_file);
+            std::swap(m_mapping, other.m_mapping);
+#endif
+        }
+
+        // 映射path，已打開的文件先關閉
+        void open(const char* path, unsigned hints = sequential | willneed)
+        {
+            close();
+#if defined(_WIN32)
+            m_file = ::CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULLPTR, OPEN_EXISTING,
+                                   (hints & sequential) ? FILE_FLAG_SEQUENTIAL_SCAN : FILE_ATTRIBUTE_NORMAL, NULLPTR);
+            if (m_file == INVALID_HANDLE_VALUE) _fail(path, "open");
+
+            LARGE_INTEGER size;
+            if (!::GetFileSizeEx(m_file, &size))
+            {
+                close();
+                _fail(path, "stat");
+            }
+            m_size = static_cast<size_type>(size.QuadPart);
+            m_open = true;
+            if (m_size == 0) return;
+
+            m_mapping = ::CreateFileMappingA(m_file, NULLPTR, PAGE_READONLY, 0, 0, NULLPTR);
+            if (m_mapping == NULLPTR)
+            {
+                close();
+                _fail(path, "map");
+            }
+            m_data = static_cast<const char*>(::MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+            if (m_data == NULLPTR)
+            {
+                close();
+                _fail(path, "map");
+            }
+#else
+            int fd = ::open(path, O_RDONLY);
+            if (fd < 0) _fail(path, "open");
+
+            struct stat st;
+            if (::fstat(fd, &st) != 0)
+            {
+                int error = errno;
+                ::close(fd);
+                errno = error;
+                _fail(path, "stat");
+            }
+            if (static_cast<unsigned long long>(st.st_size) > static_cast<unsigned long long>(size_type(-1)))
+            {
+                ::close(fd);
+                errno = EFBIG; // 32位平臺上放不下
+                _fail(path, "map");
+            }
+            if (st.st_size == 0)
+            {
+                ::close(fd);
+                m_open = true;
+                return;
+            }
+
+            int flags = MAP_PRIVATE;
+#  if defined(MAP_POPULATE)
+            if (hints & populate) flags |= MAP_POPULATE;
+#  endif
+            const size_type size = static_cast<size_type>(st.st_size);
+            void* p = ::mmap(NULLPTR, size, PROT_READ, flags, fd, 0);
+            int error = errno;
+            ::close(fd); // 映射本身持有文件的引用
+            if (p == MAP_FAILED)
+            {
+                errno = error;
+                _fail(path, "map");
+            }
+            m_data = static_cast<const char*>(p);
+            m_size = size;
+            m_open = true;
+            advise(hints);
+#endif
+        }
+
+        void open(const std::string& path, unsigned hints = sequential | willneed)
+        {
+            open(path.c_str(), hints);
+        }
+
+        // 對整個映射重新給出訪問提示，返回系統是否接受了所有提示
+        bool advise(unsigned hints) const
+        {
+            bool ok = true;
+#if !defined(_WIN32)
+            if (m_data == NULLPTR) return true;
+
+            void* p = const_cast<char*>(m_data);
+#  if defined(MADV_SEQUENTIAL)
+            if (hints & sequential) ok = ::madvise(p, m_size, MADV_SEQUENTIAL) == 0 && ok;
+#  endif
+#  if defined(MADV_WILLNEED)
+            if (hints & willneed) ok = ::madvise(p, m_size, MADV_WILLNEED) == 0 && ok;
+#  endif
+#  if defined(MADV_HUGEPAGE)
+            if (hints & huge_pages) ok = ::madvise(p, m_size, MADV_HUGEPAGE) == 0 && ok;
+#  else
+            if (hints & huge_pages) ok = false;
+#  endif
+#else
+            (void)hints;
+#endif
+            return ok;
+        }
+
+        void close() NOEXCEPT
+        {
+#if defined(_WIN32)
+            if (m_data != NULLPTR) ::UnmapViewOfFile(m_data);
+            if (m_mapping != NULLPTR) ::CloseHandle(m_mapping);
+            if (m_file != INVALID_HANDLE_VALUE) ::CloseHandle(m_file);
+            _reset_handles();
+#else
+            if (m_data != NULLPTR) ::munmap(const_cast<char*>(m_data), m_size);
+#endif
+            m_data = NULLPTR;
+            m_size = 0;
+            m_open = false;
+        }
+
+        // 空文件也算打開，但data()是NULLPTR
+        bool is_open() const
+        {
+            return m_open;
+        }
+
+        const char* data() const
+        {
+            return m_data;
+        }
+
+        size_type size() const
+        {
+            return m_size;
+        }
+
+        bool empty() const
+        {
+            return m_size == 0;
+        }
+
+        string_view view() const
+        {
+            return string_view(m_data, m_size);
+        }
+
+        // 按行遍歷整個文件
+        basic_line_view< char, std::char_traits<char> > lines() const
+        {
+            return lite::lines(view());
+        }
+
+    private:
+        mapped_file(const mapped_file&);
+        mapped_file& operator=(const mapped_file&);
+
+        void _reset_handles()
+        {
+#if defined(_WIN32)
+            m_file = INVALID_HANDLE_VALUE;
+            m_mapping = NULLPTR;
+#endif
+        }
+
+        static void _fail(const char* path, const char* what)
+        {
+#if defined(_WIN32)
+            throw std::runtime_error(std::string("lite::mapped_file: cannot ") + what + " '" + path + "'");
+#else
+            throw std::runtime_error(std::string("lite::mapped_file: cannot ") + what + " '" + path + "': " + std::strerror(errno));
+#endif
+        }
+
+        const char* m_data;
+        size_type m_size;
+        bool m_open;
+#if defined(_WIN32)
+        HANDLE m_file;
+        HANDLE m_mapping;
+#endif
+    };
+}
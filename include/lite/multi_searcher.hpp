@@ -0,0 +1,427 @@
+#pragma once
+#include <algorithm> // std::lower_bound
+#include <cstddef>   // std::size_t
+#include <deque>     // std::deque
+#include <utility>   // std::pair
+#include <vector>    // std::vector
+#include "string_view.hpp"
+
+namespace lite
+{
+    // 多模式串匹配（Aho-Corasick）。構造時把所有模式串編譯成自動機，之後每次查找只掃描文本一遍。
+    // 模式串中出現過的字節先映射成緊湊的字符類；狀態數乘字符類數不大時展開成稠密轉移表
+    // （每個字節一次查表），否則每個狀態只存自己的出邊，靠失敗指針回退。
+    // 自動機自己保存所有數據，不引用模式串的內存。空模式串不參與匹配；
+    // 重複的模式串只報告編號最小的那個。
+    class multi_searcher
+    {
+    public:
+        typedef std::size_t size_type;
+
+        struct match
+        {
+            size_type needle; // 模式串編號，即構造時的下標
+            size_type offset; // 匹配在文本中的起點
+        };
+
+        enum match_kind
+        {
+            first_match,      // 結束位置最早的一個匹配
+            all_matches,      // 所有匹配（可重疊），按結束位置排序
+            leftmost_longest  // 不重疊的匹配，起點最左，同起點取最長
+        };
+
+        // 稠密轉移表最多佔用的元素個數
+        static const size_type max_dense_cells = size_type(1) << 22;
+
+        multi_searcher()
+            : m_classes(1), m_dense(false)
+        {
+            _build(std::vector<string_view>());
+        }
+
+        // [first, last)的元素要能轉換成lite::string_view
+        template <typename InputIt>
+        multi_searcher(InputIt first, InputIt last)
+            : m_classes(1), m_dense(false)
+        {
+            std::vector<string_view> needles;
+            for (; first != last; ++first)
+            {
+                needles.push_back(string_view(*first));
+            }
+            _build(needles);
+        }
+
+        // 模式串個數
+        size_type size() const
+        {
+            return m_lengths.size();
+        }
+
+        // 自動機狀態數
+        size_type states() const
+        {
+            return m_fail.size();
+        }
+
+        bool dense() const
+        {
+            return m_dense;
+        }
+
+        size_type needle_size(size_type needle) const
+        {
+            return m_lengths[needle];
+        }
+
+        bool find_first(string_view haystack, match& result) const
+        {
+            first_sink sink(result);
+            _scan(haystack, sink);
+            return sink.found;
+        }
+
+        bool contains_any(string_view haystack) const
+        {
+            match m;
+            return find_first(haystack, m);
+        }
+
+        // 把kind指定的匹配依次寫到out，返回寫完後的out
+        template <typename OutputIt>
+        OutputIt find(string_view haystack, match_kind kind, OutputIt out) const
+        {
+            if (kind == first_match)
+            {
+                match m;
+                if (find_first(haystack, m))
+                {
+                    *out = m;
+                    ++out;
+                }
+                return out;
+            }
+            if (kind == all_matches)
+            {
+                all_sink<OutputIt> sink(out);
+                _scan(haystack, sink);
+                return sink.out;
+            }
+            return _leftmost_longest(haystack, out);
+        }
+
+    private:
+        typedef unsigned int state_type;
+
+        static state_type _none()
+        {
+            return state_type(-1);
+        }
+
+        struct first_sink
+        {
+            explicit first_sink(match& m) : result(m), found(false) {}
+
+            bool operator()(size_type needle, size_type offset)
+            {
+                if (!found)
+                {
+                    result.needle = needle;
+                    result.offset = offset;
+                    found = true;
+                }
+                return false;
+            }
+
+            match& result;
+            bool found;
+        };
+
+        template <typename OutputIt>
+        struct all_sink
+        {
+            explicit all_sink(OutputIt o) : out(o) {}
+
+            bool operator()(size_type needle, size_type offset)
+            {
+                match m;
+                m.needle = needle;
+                m.offset = offset;
+                *out = m;
+                ++out;
+                return true;
+            }
+
+            OutputIt out;
+        };
+
+        void _build(const std::vector<string_view>& needles)
+        {
+            // 字符類
+            for (size_type i = 0; i < 256; ++i)
+            {
+                m_class[i] = 0;
+            }
+            m_classes = 1;
+            for (size_type i = 0; i < needles.size(); ++i)
+            {
+                for (size_type j = 0; j < needles[i].size(); ++j)
+                {
+                    unsigned char c = static_cast<unsigned char>(needles[i][j]);
+                    if (m_class[c] == 0)
+                    {
+                        m_class[c] = static_cast<unsigned short>(m_classes++);
+                    }
+                }
+            }
+
+            // 字典樹，出邊按字符類排序
+            typedef std::vector< std::pair<unsigned, state_type> > edges;
+            std::vector<edges> trie(1);
+            m_out.assign(1, _none());
+            m_depth.assign(1, 0);
+            m_lengths.resize(needles.size());
+            for (size_type i = 0; i < needles.size(); ++i)
+            {
+                m_lengths[i] = needles[i].size();
+                if (needles[i].empty()) continue;
+
+                state_type state = 0;
+                for (size_type j = 0; j < needles[i].size(); ++j)
+                {
+                    unsigned c = m_class[static_cast<unsigned char>(needles[i][j])];
+                    edges& e = trie[state];
+                    edges::iterator it = std::lower_bound(e.begin(), e.end(), std::make_pair(c, state_type(0)));
+                    if (it != e.end() && it->first == c)
+                    {
+                        state = it->second;
+                        continue;
+                    }
+                    state_type next = static_cast<state_type>(trie.size());
+                    e.insert(it, std::make_pair(c, next));
+                    trie.push_back(edges());
+                    m_out.push_back(_none());
+                    m_depth.push_back(static_cast<state_type>(j + 1));
+                    state = next;
+                }
+                if (m_out[state] == _none())
+                {
+                    m_out[state] = static_cast<state_type>(i);
+                }
+            }
+
+            // 壓縮存儲的出邊
+            const size_type n = trie.size();
+            m_edge_begin.assign(n + 1, 0);
+            m_edge_class.clear();
+            m_edge_next.clear();
+            for (size_type s = 0; s < n; ++s)
+            {
+                m_edge_begin[s] = static_cast<state_type>(m_edge_class.size());
+                for (size_type k = 0; k < trie[s].size(); ++k)
+                {
+                    m_edge_class.push_back(static_cast<unsigned short>(trie[s][k].first));
+                    m_edge_next.push_back(trie[s][k].second);
+                }
+            }
+            m_edge_begin[n] = static_cast<state_type>(m_edge_class.size());
+
+            // 按寬度優先求失敗指針和字典後綴指針（最近的、是某個模式串結尾的後綴狀態）
+            m_fail.assign(n, 0);
+            m_dict.assign(n, _none());
+            m_report.assign(n, 0);
+            m_dense = n * m_classes <= max_dense_cells;
+            if (m_dense)
+            {
+                m_delta.assign(n * m_classes, 0);
+            }
+            else
+            {
+                m_delta.clear();
+            }
+
+            std::deque<state_type> queue;
+            queue.push_back(0);
+            while (!queue.empty())
+            {
+                state_type u = queue.front();
+                queue.pop_front();
+
+                for (size_type k = 0; k < trie[u].size(); ++k)
+                {
+                    unsigned c = trie[u][k].first;
+                    state_type v = trie[u][k].second;
+                    state_type f = 0;
+                    if (u != 0)
+                    {
+                        f = m_fail[u];
+                        state_type g = _child(f, c);
+                        while (g == _none() && f != 0)
+                        {
+                            f = m_fail[f];
+                            g = _child(f, c);
+                        }
+                        f = g == _none() ? 0 : g;
+                    }
+                    m_fail[v] = f;
+                    m_dict[v] = m_out[f] != _none() ? f : m_dict[f];
+                    m_report[v] = m_out[v] != _none() || m_dict[v] != _none();
+                    queue.push_back(v);
+                }
+
+                if (m_dense)
+                {
+                    state_type* row = &m_delta[u * m_classes];
+                    for (size_type c = 0; c < m_classes; ++c)
+                    {
+                        state_type g = _child(u, static_cast<unsigned>(c));
+                        if (g != _none())
+                        {
+                            row[c] = g;
+                        }
+                        else
+                        {
+                            row[c] = u == 0 ? 0 : m_delta[m_fail[u] * m_classes + c];
+                        }
+                    }
+                }
+            }
+        }
+
+        state_type _child(state_type s, unsigned c) const
+        {
+            const unsigned short* first = m_edge_class.empty() ? NULLPTR : &m_edge_class[0];
+            const unsigned short* b = first + m_edge_begin[s];
+            const unsigned short* e = first + m_edge_begin[s + 1];
+            const unsigned short* it = std::lower_bound(b, e, static_cast<unsigned short>(c));
+            if (it == e || *it != c) return _none();
+            return m_edge_next[it - first];
+        }
+
+        template <bool Dense>
+        state_type _step(state_type s, unsigned char byte) const
+        {
+            unsigned c = m_class[byte];
+            if (Dense) return m_delta[s * m_classes + c];
+            if (c == 0) return 0;
+            for (;;)
+            {
+                state_type g = _child(s, c);
+                if (g != _none()) return g;
+                if (s == 0) return 0;
+                s = m_fail[s];
+            }
+        }
+
+        // 把以文本位置end結尾的所有匹配交給sink，sink返回false時停止查找
+        template <typename Sink>
+        bool _report(state_type s, size_type end, Sink& sink) const
+        {
+            if (m_out[s] == _none()) s = m_dict[s];
+            for (; s != _none(); s = m_dict[s])
+            {
+                size_type needle = m_out[s];
+                if (!sink(needle, end + 1 - m_lengths[needle])) return false;
+            }
+            return true;
+        }
+
+        template <typename Sink>
+        void _scan(string_view haystack, Sink& sink) const
+        {
+            if (m_dense)
+            {
+                _scan_impl<true>(haystack, sink);
+            }
+            else
+            {
+                _scan_impl<false>(haystack, sink);
+            }
+        }
+
+        template <bool Dense, typename Sink>
+        void _scan_impl(string_view haystack, Sink& sink) const
+        {
+            const unsigned char* p = reinterpret_cast<const unsigned char*>(haystack.data());
+            const size_type n = haystack.size();
+            const unsigned char* report = &m_report[0];
+            state_type s = 0;
+            for (size_type i = 0; i < n; ++i)
+            {
+                s = _step<Dense>(s, p[i]);
+                if (report[s] && !_report(s, i, sink)) return;
+            }
+        }
+
+        // 記錄當前最好的候選匹配：起點最小，其次最長
+        struct leftmost_sink
+        {
+            leftmost_sink(const multi_searcher& self) : searcher(self), found(false), needle(0), offset(0) {}
+
+            bool operator()(size_type n, size_type o)
+            {
+                if (!found || o < offset || (o == offset && searcher.m_lengths[n] > searcher.m_lengths[needle]))
+                {
+                    found = true;
+                    needle = n;
+                    offset = o;
+                }
+                return true;
+            }
+
+            const multi_searcher& searcher;
+            bool found;
+            size_type needle;
+            size_type offset;
+        };
+
+        template <typename OutputIt>
+        OutputIt _leftmost_longest(string_view haystack, OutputIt out) const
+        {
+            const unsigned char* p = reinterpret_cast<const unsigned char*>(haystack.data());
+            const size_type n = haystack.size();
+            size_type i = 0;
+            state_type s = 0;
+            leftmost_sink best(*this);
+            while (i < n)
+            {
+                s = m_dense ? _step<true>(s, p[i]) : _step<false>(s, p[i]);
+                if (m_report[s])
+                {
+                    _report(s, i, best);
+                }
+                ++i;
+
+                // 以後的匹配起點不早於i - depth，候選的起點比它更早時就不會再被超過
+                if (best.found && (best.offset < i - m_depth[s] || i == n))
+                {
+                    match m;
+                    m.needle = best.needle;
+                    m.offset = best.offset;
+                    *out = m;
+                    ++out;
+
+                    i = best.offset + m_lengths[best.needle];
+                    s = 0;
+                    best.found = false;
+                }
+            }
+            return out;
+        }
+
+        unsigned short m_class[256];
+        size_type m_classes;
+        bool m_dense;
+        std::vector<size_type> m_lengths;
+        std::vector<state_type> m_out;
+        std::vector<state_type> m_depth;
+        std::vector<state_type> m_fail;
+        std::vector<state_type> m_dict;
+        std::vector<unsigned char> m_report; // 狀態上是否有匹配要報告
+        std::vector<state_type> m_edge_begin;
+        std::vector<unsigned short> m_edge_class;
+        std::vector<state_type> m_edge_next;
+        std::vector<state_type> m_delta;
+    };
+}
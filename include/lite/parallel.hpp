@@ -0,0 +1,466 @@
+#pragma once
+#include <atomic>             // std::atomic
+#include <condition_variable> // std::condition_variable
+#include <cstddef>            // std::size_t
+#include <exception>          // std::exception_ptr
+#include <functional>         // std::function
+#include <memory>             // std::unique_ptr
+#include <mutex>              // std::mutex, std::lock_guard, std::unique_lock
+#include <thread>             // std::thread
+#include <vector>             // std::vector
+#include "macro.hpp"
+#include "string_view.hpp"
+#include "searcher.hpp"
+
+// 多線程查找，需要C++11
+namespace lite
+{
+    namespace parallel
+    {
+        // 工作竊取線程池。for_each_index把下標[0, n)按線程數切成連續的段，每個線程從自己那段的前端取，
+        // 做完後從別的線程的段的後端偷一半。調用線程也參與，size()個線程裏有size() - 1個是池中的線程。
+        // 同一時間只運行一個for_each_index，不能在任務裏再調用它。
+        class thread_pool
+        {
+        public:
+            // threads爲0時用std::thread::hardware_concurrency()
+            explicit thread_pool(unsigned threads = 0)
+                : m_size(threads != 0 ? threads : std::thread::hardware_concurrency()),
+                  m_generation(0), m_busy(0), m_stop(false)
+            {
+                if (m_size == 0) m_size = 1;
+                m_ranges.reset(new _range[m_size]);
+                for (unsigned i = 1; i < m_size; ++i)
+                {
+                    m_threads.push_back(std::thread(&thread_pool::_worker, this, i));
+                }
+            }
+
+            ~thread_pool()
+            {
+                {
+                    std::lock_guard<std::mutex> guard(m_lock);
+                    m_stop = true;
+                }
+                m_wake.notify_all();
+                for (std::size_t i = 0; i < m_threads.size(); ++i) m_threads[i].join();
+            }
+
+            unsigned size() const
+            {
+                return m_size;
+            }
+
+            // 對[0, n)中每個下標調用一次f，全部完成後返回。f拋出的第一個異常在這裏重新拋出
+            template <typename F>
+            void for_each_index(std::size_t n, F f)
+            {
+                std::lock_guard<std::mutex> run(m_run_lock);
+                if (n == 0) return;
+
+                std::function<void(std::size_t)> job(f);
+                {
+                    std::lock_guard<std::mutex> guard(m_lock);
+                    for (unsigned i = 0; i < m_size; ++i)
+                    {
+                        std::lock_guard<std::mutex> range_guard(m_ranges[i].m_lock);
+                        m_ranges[i].m_begin = n * i / m_size;
+                        m_ranges[i].m_end = n * (i + 1) / m_size;
+                    }
+                    m_job = &job;
+                    m_error = std::exception_ptr();
+                    m_busy = m_size - 1;
+                    ++m_generation;
+                }
+                m_wake.notify_all();
+
+                _work(0);
+
+                std::unique_lock<std::mutex> guard(m_lock);
+                m_done.wait(guard, [this] { return m_busy == 0; });
+                m_job = NULLPTR;
+                if (m_error) std::rethrow_exception(m_error);
+            }
+
+        private:
+            struct _range
+            {
+                _range() : m_begin(0), m_end(0) {}
+
+                std::mutex m_lock;
+                std::size_t m_begin;
+                std::size_t m_end;
+            };
+
+            void _worker(unsigned self)
+            {
+                unsigned long long seen = 0;
+                for (;;)
+                {
+                    {
+                        std::unique_lock<std::mutex> guard(m_lock);
+                        m_wake.wait(guard, [&] { return m_stop || m_generation != seen; });
+                        if (m_stop) return;
+                        seen = m_generation;
+                    }
+                    _work(self);
+                    std::lock_guard<std::mutex> guard(m_lock);
+                    if (--m_busy == 0) m_done.notify_one();
+                }
+            }
+
+            void _work(unsigned self)
+            {
+                std::size_t i;
+                while (_pop(self, i) || (_steal(self) && _pop(self, i)))
+                {
+                    try
+                    {
+                        (*m_job)(i);
+                    }
+                    catch (...)
+                    {
+                        std::lock_guard<std::mutex> guard(m_lock);
+                        if (!m_error) m_error = std::current_exception();
+                    }
+                }
+            }
+
+            bool _pop(unsigned self, std::size_t& i)
+            {
+                _range& r = m_ranges[self];
+                std::lock_guard<std::mutex> guard(r.m_lock);
+                if (r.m_begin == r.m_end) return false;
+                i = r.m_begin++;
+                return true;
+            }
+
+            // 從下一個線程開始找還有剩餘的段，把它的後一半搬到自己的段裏
+            bool _steal(unsigned self)
+            {
+                for (unsigned k = 1; k < m_size; ++k)
+                {
+                    _range& victim = m_ranges[(self + k) % m_size];
+                    std::size_t begin;
+                    std::size_t end;
+                    {
+                        std::lock_guard<std::mutex> guard(victim.m_lock);
+                        if (victim.m_begin == victim.m_end) continue;
+                        end = victim.m_end;
+                        begin = victim.m_begin + (victim.m_end - victim.m_begin) / 2;
+                        victim.m_end = begin;
+                    }
+                    _range& mine = m_ranges[self];
+                    std::lock_guard<std::mutex> guard(mine.m_lock);
+                    mine.m_begin = begin;
+                    mine.m_end = end;
+                    return true;
+                }
+                return false;
+            }
+
+            thread_pool(const thread_pool&);
+            thread_pool& operator=(const thread_pool&);
+
+            unsigned m_size;
+            std::vector<std::thread> m_threads;
+            std::unique_ptr<_range[]> m_ranges;
+            std::mutex m_run_lock;
+            std::mutex m_lock;
+            std::condition_variable m_wake;
+            std::condition_variable m_done;
+            std::function<void(std::size_t)>* m_job;
+            std::exception_ptr m_error;
+            unsigned long long m_generation;
+            unsigned m_busy;
+            bool m_stop;
+        };
+
+        // 進程內共用的線程池，第一次使用時創建
+        inline thread_pool& default_pool()
+        {
+            static thread_pool pool;
+            return pool;
+        }
+
+        struct options
+        {
+            options() : chunk_bytes(256 * 1024), pool(NULLPTR) {}
+
+            std::size_t chunk_bytes; // 每塊的候選起點佔的字節數，默認與L2緩存相當
+            thread_pool* pool;       // NULLPTR時用default_pool()
+        };
+
+        template <typename T>
+        struct _identity
+        {
+            typedef T type;
+        };
+
+        inline thread_pool& _pool(const options& o)
+        {
+            return o.pool != NULLPTR ? *o.pool : default_pool();
+        }
+
+        inline std::size_t _chunk(const options& o, std::size_t char_size, std::size_t m)
+        {
+            std::size_t chunk = o.chunk_bytes / char_size;
+            return chunk > m ? chunk : m + 1;
+        }
+
+        // 把候選起點[first, last)按chunk分塊，並行找第一個（reverse時最後一個）匹配。
+        // scan(begin, end)只找起點在[begin, end)內的匹配，可以讀到end之後；找不到返回npos。
+        // 已經有更靠前（reverse時更靠後）的塊找到時，後面的塊不再掃描
+        template <typename Scan>
+        std::size_t _find_chunked(std::size_t first, std::size_t last, std::size_t chunk, bool reverse,
+                                  thread_pool& pool, Scan scan)
+        {
+            const std::size_t npos = std::size_t(-1);
+            if (first >= last) return npos;
+            const std::size_t chunks = (last - first + chunk - 1) / chunk;
+            if (chunks == 1 || pool.size() == 1) return scan(first, last);
+
+            std::vector<std::size_t> hits(chunks, npos);
+            std::atomic<std::size_t> best(chunks);
+            pool.for_each_index(chunks, [&](std::size_t task) {
+                if (task > best.load(std::memory_order_relaxed)) return;
+                const std::size_t i = reverse ? chunks - 1 - task : task;
+                const std::size_t begin = first + i * chunk;
+                const std::size_t end = last - begin > chunk ? begin + chunk : last;
+                const std::size_t p = scan(begin, end);
+                if (p == npos) return;
+                hits[task] = p;
+                std::size_t current = best.load(std::memory_order_relaxed);
+                while (task < current && !best.compare_exchange_weak(current, task, std::memory_order_relaxed))
+                {
+                }
+            });
+            const std::size_t b = best.load(std::memory_order_relaxed);
+            return b < chunks ? hits[b] : npos;
+        }
+
+        // 第一個不早於pos的匹配位置，與basic_string_view::find相同
+        template <typename CharT, typename Traits>
+        std::size_t find(basic_string_view<CharT, Traits> haystack,
+                         typename _identity<basic_string_view<CharT, Traits> >::type needle,
+                         std::size_t pos = 0, const options& o = options())
+        {
+            typedef basic_string_view<CharT, Traits> view_type;
+            const std::size_t m = needle.size();
+            if (pos > haystack.size() || haystack.size() - pos < m) return view_type::_npos();
+            if (m == 0) return pos;
+
+            const searcher<CharT, Traits> s(needle);
+            const CharT* h = haystack.data();
+            // 起點在[begin, end)內的匹配要讀到end + m - 1，相鄰的塊重疊m - 1個字符
+            return _find_chunked(pos, haystack.size() - m + 1, _chunk(o, sizeof(CharT), m), false, _pool(o),
+                                 [&](std::size_t begin, std::size_t end) {
+                                     const std::size_t p = s.find(view_type(h + begin, end - begin + m - 1));
+                                     return p == view_type::_npos() ? p : begin + p;
+                                 });
+        }
+
+        template <typename CharT, typename Traits>
+        std::size_t find(basic_string_view<CharT, Traits> haystack, CharT ch, std::size_t pos = 0, const options& o = options())
+        {
+            return parallel::find(haystack, basic_string_view<CharT, Traits>(&ch, 1), pos, o);
+        }
+
+        // [first, last)中第一個在（In爲false時不在）集合中的字符
+        template <bool In, typename CharT, typename Traits>
+        std::size_t _find_first_of(basic_string_view<CharT, Traits> haystack, basic_string_view<CharT, Traits> set,
+                                   std::size_t pos, const options& o)
+        {
+            typedef basic_string_view<CharT, Traits> view_type;
+            if (pos >= haystack.size()) return view_type::_npos();
+
+            const CharT* h = haystack.data();
+            return _find_chunked(pos, haystack.size(), _chunk(o, sizeof(CharT), 1), false, _pool(o),
+                                 [&](std::size_t begin, std::size_t end) {
+                                     const view_type part(h + begin, end - begin);
+                                     const std::size_t p = In ? part.find_first_of(set) : part.find_first_not_of(set);
+                                     return p == view_type::_npos() ? p : begin + p;
+                                 });
+        }
+
+        template <bool In, typename CharT, typename Traits>
+        std::size_t _find_last_of(basic_string_view<CharT, Traits> haystack, basic_string_view<CharT, Traits> set,
+                                  std::size_t pos, const options& o)
+        {
+            typedef basic_string_view<CharT, Traits> view_type;
+            if (haystack.empty()) return view_type::_npos();
+
+            const CharT* h = haystack.data();
+            const std::size_t last = (pos < haystack.size() - 1 ? pos : haystack.size() - 1) + 1;
+            return _find_chunked(0, last, _chunk(o, sizeof(CharT), 1), true, _pool(o),
+                                 [&](std::size_t begin, std::size_t end) {
+                                     const view_type part(h + begin, end - begin);
+                                     const std::size_t p = In ? part.find_last_of(set) : part.find_last_not_of(set);
+                                     return p == view_type::_npos() ? p : begin + p;
+                                 });
+        }
+
+        template <typename CharT, typename Traits>
+        std::size_t find_first_of(basic_string_view<CharT, Traits> haystack,
+                                  typename _identity<basic_string_view<CharT, Traits> >::type set,
+                                  std::size_t pos = 0, const options& o = options())
+        {
+            return _find_first_of<true>(haystack, set, pos, o);
+        }
+
+        template <typename CharT, typename Traits>
+        std::size_t find_first_not_of(basic_string_view<CharT, Traits> haystack,
+                                      typename _identity<basic_string_view<CharT, Traits> >::type set,
+                                      std::size_t pos = 0, const options& o = options())
+        {
+            return _find_first_of<false>(haystack, set, pos, o);
+        }
+
+        template <typename CharT, typename Traits>
+        std::size_t find_last_of(basic_string_view<CharT, Traits> haystack,
+                                 typename _identity<basic_string_view<CharT, Traits> >::type set,
+                                 std::size_t pos = std::size_t(-1), const options& o = options())
+        {
+            return _find_last_of<true>(haystack, set, pos, o);
+        }
+
+        template <typename CharT, typename Traits>
+        std::size_t find_last_not_of(basic_string_view<CharT, Traits> haystack,
+                                     typename _identity<basic_string_view<CharT, Traits> >::type set,
+                                     std::size_t pos = std::size_t(-1), const options& o = options())
+        {
+            return _find_last_of<false>(haystack, set, pos, o);
+        }
+
+        // 不重疊匹配的並行版本。每塊先各自從塊首貪心地找出一串匹配，再按順序拼接：
+        // 上一塊最後的匹配伸進本塊時，從它的末尾重新找，直到與本塊的那串匹配重合，之後的部分照用
+        template <typename CharT, typename Traits>
+        class _matches
+        {
+        public:
+            typedef basic_string_view<CharT, Traits> view_type;
+
+            _matches(view_type haystack, view_type needle, const options& o, bool keep)
+                : m_haystack(haystack), m_searcher(needle), m_m(needle.size()),
+                  m_chunk(_chunk(o, sizeof(CharT), needle.size())), m_keep(keep)
+            {
+                const std::size_t n = haystack.size();
+                m_last = n >= m_m ? n - m_m + 1 : 0;
+                const std::size_t chunks = (m_last + m_chunk - 1) / m_chunk;
+                m_chunks.resize(chunks);
+                _pool(o).for_each_index(chunks, [this](std::size_t i) {
+                    _chunk_result& c = m_chunks[i];
+                    const std::size_t begin = i * m_chunk;
+                    const std::size_t end = _end(begin);
+                    for (std::size_t p = _next(begin, end); p != npos(); p = _next(p + m_m, end))
+                    {
+                        ++c.m_count;
+                        c.m_last_match = p;
+                        if (m_keep) c.m_positions.push_back(p);
+                    }
+                });
+            }
+
+            // 按順序把每個匹配交給out(pos)，返回匹配個數
+            template <typename Out>
+            std::size_t stitch(Out out) const
+            {
+                std::size_t total = 0;
+                std::size_t allowed = 0; // 下一個匹配的最小起點
+                for (std::size_t i = 0; i < m_chunks.size(); ++i)
+                {
+                    const _chunk_result& c = m_chunks[i];
+                    const std::size_t begin = i * m_chunk;
+                    const std::size_t end = _end(begin);
+                    std::size_t skipped = 0; // 本塊的那串匹配中被跳過的個數
+                    if (allowed > begin)
+                    {
+                        std::size_t a = _next(begin, end);
+                        std::size_t b = _next(allowed, end);
+                        while (b != npos())
+                        {
+                            while (a != npos() && a < b)
+                            {
+                                a = _next(a + m_m, end);
+                                ++skipped;
+                            }
+                            if (a == b) break;
+                            out(b);
+                            ++total;
+                            allowed = b + m_m;
+                            b = _next(allowed, end);
+                        }
+                        if (b == npos()) continue; // 沒有重合，本塊剩下的都被擋住了
+                    }
+                    if (m_keep)
+                    {
+                        for (std::size_t k = skipped; k < c.m_positions.size(); ++k) out(c.m_positions[k]);
+                    }
+                    total += c.m_count - skipped;
+                    if (c.m_count > skipped) allowed = c.m_last_match + m_m;
+                }
+                return total;
+            }
+
+        private:
+            struct _chunk_result
+            {
+                _chunk_result() : m_count(0), m_last_match(0) {}
+
+                std::size_t m_count;
+                std::size_t m_last_match;
+                std::vector<std::size_t> m_positions;
+            };
+
+            static std::size_t npos()
+            {
+                return view_type::_npos();
+            }
+
+            std::size_t _end(std::size_t begin) const
+            {
+                return m_last - begin > m_chunk ? begin + m_chunk : m_last;
+            }
+
+            // 起點在[from, end)內的第一個匹配
+            std::size_t _next(std::size_t from, std::size_t end) const
+            {
+                if (from >= end) return npos();
+                const std::size_t p = m_searcher.find(view_type(m_haystack.data() + from, end - from + m_m - 1));
+                return p == npos() ? p : from + p;
+            }
+
+            view_type m_haystack;
+            searcher<CharT, Traits> m_searcher;
+            std::size_t m_m;
+            std::size_t m_chunk;
+            std::size_t m_last; // 候選起點是[0, m_last)
+            bool m_keep;
+            std::vector<_chunk_result> m_chunks;
+        };
+
+        // 不重疊的匹配個數，與searcher::count相同
+        template <typename CharT, typename Traits>
+        std::size_t count(basic_string_view<CharT, Traits> haystack,
+                          typename _identity<basic_string_view<CharT, Traits> >::type needle,
+                          const options& o = options())
+        {
+            if (needle.empty()) return haystack.size() + 1;
+            return _matches<CharT, Traits>(haystack, needle, o, false).stitch([](std::size_t) {});
+        }
+
+        // 依次把每個不重疊的匹配位置寫到out，返回寫完後的out，與searcher::find_all相同
+        template <typename CharT, typename Traits, typename OutputIt>
+        OutputIt find_all(basic_string_view<CharT, Traits> haystack,
+                          typename _identity<basic_string_view<CharT, Traits> >::type needle,
+                          OutputIt out, const options& o = options())
+        {
+            if (needle.empty()) return searcher<CharT, Traits>(needle).find_all(haystack, out);
+            _matches<CharT, Traits>(haystack, needle, o, true).stitch([&out](std::size_t p) {
+                *out = p;
+                ++out;
+            });
+            return out;
+        }
+    }
+}
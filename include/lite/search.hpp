@@ -0,0 +1,572 @@
+#pragma once
+#include <cassert> // assert
+#include <cstddef> // std::size_t
+#include <string>  // std::char_traits
+#include "macro.hpp"
+#include "simd.hpp"
+
+namespace lite
+{
+    // Traits是否爲std::char_traits，是則字符相等等價於編碼相等
+    template <typename CharT, typename Traits>
+    struct is_std_char_traits
+    {
+        static const bool value = false;
+    };
+
+    template <typename CharT>
+    struct is_std_char_traits<CharT, std::char_traits<CharT> >
+    {
+        static const bool value = true;
+    };
+
+    // Two-Way字符串匹配（Crochemore-Perrin），最壞情況線性時間，常數額外空間。
+    // Traits爲std::char_traits時額外用一張256項的壞字符表跳躍（Horspool），
+    // 自定義Traits的eq可能讓不同的編碼相等，不能按編碼建表。
+    // Reverse爲true時在逆序的模式串和文本上運行，找的是最後一個匹配。
+    template <typename CharT, typename Traits, bool Reverse = false>
+    class two_way
+    {
+    public:
+        typedef std::size_t size_type;
+
+        two_way()
+            : m_needle(NULLPTR), m_size(0), m_suffix(0), m_period(1), m_periodic(false)
+        {
+        }
+
+        two_way(const CharT* needle, size_type count)
+            : m_needle(needle), m_size(count), m_suffix(0), m_period(1), m_periodic(false)
+        {
+            if (count == 0) return;
+
+            size_type period_lt;
+            size_type suffix_lt = _max_suffix(false, period_lt);
+            size_type period_gt;
+            size_type suffix_gt = _max_suffix(true, period_gt);
+
+            if (suffix_lt + 1 < suffix_gt + 1)
+            {
+                m_suffix = suffix_gt + 1;
+                m_period = period_gt;
+            }
+            else
+            {
+                m_suffix = suffix_lt + 1;
+                m_period = period_lt;
+            }
+
+            m_periodic = m_suffix <= count - m_period;
+            for (size_type i = 0; m_periodic && i < m_suffix; ++i)
+            {
+                m_periodic = Traits::eq(_at(needle, count, i), _at(needle, count, i + m_period));
+            }
+            if (!m_periodic)
+            {
+                m_period = (m_suffix > count - m_suffix ? m_suffix : count - m_suffix) + 1;
+            }
+
+            if (!is_std_char_traits<CharT, Traits>::value) return;
+
+            // 表項用32位，超過的跳躍距離截到0xFFFFFFFF，跳得少一些仍然正確
+            const size_type limit = 0xFFFFFFFFu;
+            for (size_type i = 0; i < 256; ++i)
+            {
+                m_shift[i] = static_cast<unsigned>(count < limit ? count : limit);
+            }
+            for (size_type i = 0; i < count; ++i)
+            {
+                const size_type shift = count - 1 - i;
+                m_shift[_bucket(_at(needle, count, i))] = static_cast<unsigned>(shift < limit ? shift : limit);
+            }
+        }
+
+        const CharT* needle() const { return m_needle; }
+        size_type size() const { return m_size; }
+
+        // 在[h, h + n)中查找，返回第一個（Reverse時最後一個）匹配的位置，找不到返回NULLPTR
+        const CharT* find(const CharT* h, size_type n) const
+        {
+            const size_type m = m_size;
+            if (m == 0) return h;
+            if (n < m) return NULLPTR;
+
+            const CharT* s = m_needle;
+            size_type j = 0;
+            size_type memory = 0;
+            while (j <= n - m)
+            {
+                if (is_std_char_traits<CharT, Traits>::value)
+                {
+                    size_type shift = m_shift[_bucket(_at(h, n, j + m - 1))];
+                    if (shift > 0)
+                    {
+                        if (m_periodic && memory != 0 && shift < m_period)
+                        {
+                            shift = m - m_period;
+                        }
+                        memory = 0;
+                        j += shift;
+                        continue;
+                    }
+                }
+
+                size_type i = m_suffix > memory ? m_suffix : memory;
+                while (i < m && Traits::eq(_at(s, m, i), _at(h, n, i + j)))
+                {
+                    ++i;
+                }
+                if (i < m)
+                {
+                    j += i - m_suffix + 1;
+                    memory = 0;
+                    continue;
+                }
+
+                i = m_suffix;
+                while (i > memory && Traits::eq(_at(s, m, i - 1), _at(h, n, i - 1 + j)))
+                {
+                    --i;
+                }
+                if (i <= memory) return Reverse ? h + (n - m - j) : h + j;
+
+                j += m_period;
+                memory = m_periodic ? m - m_period : 0;
+            }
+            return NULLPTR;
+        }
+
+    private:
+        static unsigned char _bucket(CharT c)
+        {
+            return static_cast<unsigned char>(c);
+        }
+
+        // 長度爲n的串的第i個字符，Reverse時從末尾數起
+        static CharT _at(const CharT* p, size_type n, size_type i)
+        {
+            return Reverse ? p[n - 1 - i] : p[i];
+        }
+
+        // 最大後綴（gt爲true時按逆序比較），返回後綴起點減一，period爲其週期
+        size_type _max_suffix(bool gt, size_type& period) const
+        {
+            const CharT* s = m_needle;
+            const size_type m = m_size;
+            size_type max_suffix = size_type(-1);
+            size_type j = 0;
+            size_type k = 1;
+            size_type p = 1;
+            while (j + k < m_size)
+            {
+                CharT a = _at(s, m, j + k);
+                CharT b = _at(s, m, max_suffix + k);
+                if (gt ? Traits::lt(b, a) : Traits::lt(a, b))
+                {
+                    j += k;
+                    k = 1;
+                    p = j - max_suffix;
+                }
+                else if (Traits::eq(a, b))
+                {
+                    if (k != p)
+                    {
+                        ++k;
+                    }
+                    else
+                    {
+                        j += p;
+                        k = 1;
+                    }
+                }
+                else
+                {
+                    max_suffix = j++;
+                    k = p = 1;
+                }
+            }
+            period = p;
+            return max_suffix;
+        }
+
+        const CharT* m_needle;
+        size_type m_size;
+        size_type m_suffix;
+        size_type m_period;
+        bool m_periodic;
+        unsigned m_shift[256];
+    };
+
+    // 中等長度模式串（2到256個字符）的Horspool變體：按窗口末尾兩個字符的散列查表，
+    // 模式串中沒有的字符對直接跳過m - 1個位置。只用於std::char_traits。
+    template <typename CharT>
+    class pair_horspool
+    {
+    public:
+        typedef std::size_t size_type;
+
+        static const size_type max_size = 256;
+
+        pair_horspool()
+            : m_needle(NULLPTR), m_size(0), m_shift1(0)
+        {
+        }
+
+        pair_horspool(const CharT* needle, size_type count)
+            : m_needle(needle), m_size(count), m_shift1(0)
+        {
+            assert(count >= 2 && count <= max_size);
+
+            const size_type m1 = count - 1;
+            for (size_type i = 0; i < 256; ++i)
+            {
+                m_shift[i] = 0;
+            }
+            for (size_type i = 1; i < m1; ++i)
+            {
+                m_shift[_hash(needle + i)] = static_cast<unsigned char>(i);
+            }
+            m_shift1 = m1 - m_shift[_hash(needle + m1)];
+            m_shift[_hash(needle + m1)] = static_cast<unsigned char>(m1);
+        }
+
+        const CharT* needle() const { return m_needle; }
+        size_type size() const { return m_size; }
+
+        const CharT* find(const CharT* h, size_type n) const
+        {
+            const size_type m = m_size;
+            if (n < m) return NULLPTR;
+
+            const size_type m1 = m - 1;
+            const CharT* const last = h + (n - m);
+            const CharT* s = m_needle;
+            size_type offset = 0;
+            const CharT* checked = h;
+            size_type rounds = 0;
+            while (h <= last)
+            {
+                // 重複度高的文本裏每輪只移動一兩個字符，平均不到4個時把剩下的部分交給Two-Way，保證線性時間
+                if (++rounds % 1024 == 0)
+                {
+                    if (static_cast<size_type>(h - checked) < 4 * 1024)
+                    {
+                        return two_way<CharT, std::char_traits<CharT> >(s, m).find(h, static_cast<size_type>(last - h) + m);
+                    }
+                    checked = h;
+                }
+
+                // h在循環裏指向窗口末尾，跳過模式串中不存在的字符對
+                size_type shift;
+                do
+                {
+                    h += m1;
+                    shift = m_shift[_hash(h)];
+                } while (shift == 0 && h <= last);
+
+                h -= shift;
+                if (shift < m1) continue;
+
+                if (m1 < 15 || simd::verify(h + offset, s + offset, 8))
+                {
+                    if (simd::verify(h, s, m)) return h;
+                    offset = (offset >= 8 ? offset : m1) - 8;
+                }
+                h += m_shift1;
+            }
+            return NULLPTR;
+        }
+
+    private:
+        static unsigned char _hash(const CharT* p)
+        {
+            return static_cast<unsigned char>(static_cast<size_type>(p[0]) - (static_cast<size_type>(p[-1]) << 3));
+        }
+
+        const CharT* m_needle;
+        size_type m_size;
+        size_type m_shift1;
+        unsigned char m_shift[256];
+    };
+
+    namespace simd
+    {
+        // 短模式串：同時比較模式串中兩個錨點位置（i1、i2）的字符，兩者都命中的位置再整體校驗（Muła的generic SIMD）
+        template <typename T>
+        const T* search_anchor(const T* h, std::size_t n, const T* s, std::size_t m, std::size_t i1, std::size_t i2)
+        {
+            const T* const last = h + (n - m);
+            const T* p = h;
+#if defined(LITE_SSE2)
+            const std::size_t Width = sizeof(T);
+            typedef lane<Width> L;
+#endif
+#if defined(LITE_AVX2)
+            {
+                const std::size_t step = 32 / Width;
+                const __m256i c1 = L::set1_256(static_cast<typename L::type>(s[i1]));
+                const __m256i c2 = L::set1_256(static_cast<typename L::type>(s[i2]));
+                for (; p <= last && static_cast<std::size_t>(last - p) >= step - 1; p += step)
+                {
+                    __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i1));
+                    __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i2));
+                    unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(
+                        _mm256_and_si256(L::cmpeq(a, c1), L::cmpeq(b, c2))));
+                    while (mask != 0)
+                    {
+                        unsigned idx = ctz(mask) / Width;
+                        if (simd::verify(p + idx, s, m)) return p + idx;
+                        mask &= ~(((1u << Width) - 1u) << (idx * Width));
+                    }
+                }
+            }
+#endif
+#if defined(LITE_SSE2)
+            {
+                const std::size_t step = 16 / Width;
+                const __m128i c1 = L::set1(static_cast<typename L::type>(s[i1]));
+                const __m128i c2 = L::set1(static_cast<typename L::type>(s[i2]));
+                for (; p <= last && static_cast<std::size_t>(last - p) >= step - 1; p += step)
+                {
+                    __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i1));
+                    __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i2));
+                    unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(
+                        _mm_and_si128(L::cmpeq(a, c1), L::cmpeq(b, c2))));
+                    while (mask != 0)
+                    {
+                        unsigned idx = ctz(mask) / Width;
+                        if (simd::verify(p + idx, s, m)) return p + idx;
+                        mask &= ~(((1u << Width) - 1u) << (idx * Width));
+                    }
+                }
+            }
+#endif
+            for (; p <= last; ++p)
+            {
+                if (p[i1] == s[i1] && p[i2] == s[i2] && simd::verify(p, s, m)) return p;
+            }
+            return NULLPTR;
+        }
+
+        template <typename T>
+        const T* search_first_last(const T* h, std::size_t n, const T* s, std::size_t m)
+        {
+            return search_anchor(h, n, s, m, 0, m - 1);
+        }
+
+        // search_anchor的逆向版本，從末尾開始掃描，返回最後一個匹配
+        template <typename T>
+        const T* rsearch_anchor(const T* h, std::size_t n, const T* s, std::size_t m, std::size_t i1, std::size_t i2)
+        {
+            std::size_t k = n - m + 1; // 未檢查的起點[0, k)
+#if defined(LITE_SSE2)
+            const std::size_t Width = sizeof(T);
+            typedef lane<Width> L;
+#endif
+#if defined(LITE_AVX2)
+            {
+                const std::size_t step = 32 / Width;
+                const __m256i c1 = L::set1_256(static_cast<typename L::type>(s[i1]));
+                const __m256i c2 = L::set1_256(static_cast<typename L::type>(s[i2]));
+                while (k >= step)
+                {
+                    k -= step;
+                    __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(h + k + i1));
+                    __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(h + k + i2));
+                    unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(
+                        _mm256_and_si256(L::cmpeq(a, c1), L::cmpeq(b, c2))));
+                    while (mask != 0)
+                    {
+                        unsigned idx = bsr(mask) / Width;
+                        if (simd::verify(h + k + idx, s, m)) return h + k + idx;
+                        mask &= ~(((1u << Width) - 1u) << (idx * Width));
+                    }
+                }
+            }
+#endif
+#if defined(LITE_SSE2)
+            {
+                const std::size_t step = 16 / Width;
+                const __m128i c1 = L::set1(static_cast<typename L::type>(s[i1]));
+                const __m128i c2 = L::set1(static_cast<typename L::type>(s[i2]));
+                while (k >= step)
+                {
+                    k -= step;
+                    __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(h + k + i1));
+                    __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(h + k + i2));
+                    unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(
+                        _mm_and_si128(L::cmpeq(a, c1), L::cmpeq(b, c2))));
+                    while (mask != 0)
+                    {
+                        unsigned idx = bsr(mask) / Width;
+                        if (simd::verify(h + k + idx, s, m)) return h + k + idx;
+                        mask &= ~(((1u << Width) - 1u) << (idx * Width));
+                    }
+                }
+            }
+#endif
+            while (k > 0)
+            {
+                --k;
+                const T* p = h + k;
+                if (p[i1] == s[i1] && p[i2] == s[i2] && simd::verify(p, s, m)) return p;
+            }
+            return NULLPTR;
+        }
+    }
+
+    // 字節在一般文本（英文、UTF-8中文、日誌）中的大致常見程度，0最罕見，255最常見
+    inline unsigned char byte_rank(unsigned char c)
+    {
+        static const unsigned char table[256] = {
+                107,  28,  29,  30,  31,  32,  33,  34,  35, 199, 225,  36,  37, 189,  38,  39,
+                 40,  41,  42,  43,  44,  45,  46,  47,  48,  49,  50,  51,  52,  53,  54,  55,
+                255,  97, 213,  98,  94,  99, 101, 200, 190, 191, 102, 103, 218, 214, 226, 215,
+                219, 220, 221, 203, 204, 205, 206, 207, 208, 209, 216, 192, 110, 210, 111, 104,
+                 95, 231, 186, 201, 217, 234, 196, 194, 223, 228,  91, 106, 212, 197, 227, 229,
+                193,  90, 222, 224, 232, 202, 112, 198,  92, 195,  57, 113, 100, 114,  58, 211,
+                 59, 252, 235, 242, 245, 254, 239, 237, 247, 250, 187, 230, 244, 240, 249, 251,
+                236, 115, 246, 248, 253, 243, 233, 241, 188, 238, 105, 108,  96, 109,  93,  56,
+                116, 117, 118, 119, 120, 121, 122, 123, 124, 125, 126, 127, 128, 129, 130, 131,
+                132, 133, 134, 135, 136, 137, 138, 139, 140, 141, 142, 143, 144, 145, 146, 147,
+                148, 149, 150, 151, 152, 153, 154, 155, 156, 157, 158, 159, 160, 161, 162, 163,
+                164, 165, 166, 167, 168, 169, 170, 171, 172, 173, 174, 175, 176, 177, 178, 179,
+                  0,   1,  60,  61,  62,  63,  64,  65,  66,  67,  68,  69,  70,  71,  72,  73,
+                 74,  75,  76,  77,  78,  79,  80,  81,  82,  83,  84,  85,  86,  87,  88,  89,
+                  2,   3,   4,   5, 180, 181, 182, 183, 184, 185,   6,   7,   8,   9,  10,  11,
+                 12,  13,  14,  15,  16,  17,  18,  19,  20,  21,  22,  23,  24,  25,  26,  27,
+        };
+        return table[c];
+    }
+
+    // 選出模式串中最罕見的兩個位置作爲SIMD過濾的錨點，i1 != i2（m >= 2）。
+    // 寬字符沒有頻率表，取首尾字符。
+    template <typename CharT>
+    void rare_anchors(const CharT* s, std::size_t m, std::size_t& i1, std::size_t& i2)
+    {
+        i1 = 0;
+        i2 = m - 1;
+        if (sizeof(CharT) != 1) return;
+
+        for (std::size_t i = 0; i < m; ++i)
+        {
+            unsigned char r = byte_rank(static_cast<unsigned char>(s[i]));
+            if (r < byte_rank(static_cast<unsigned char>(s[i1])))
+            {
+                i1 = i;
+            }
+        }
+        i2 = i1 == 0 ? 1 : 0;
+        for (std::size_t i = 0; i < m; ++i)
+        {
+            unsigned char r = byte_rank(static_cast<unsigned char>(s[i]));
+            if (i != i1 && r < byte_rank(static_cast<unsigned char>(s[i2])))
+            {
+                i2 = i;
+            }
+        }
+    }
+
+    // 子串查找。按模式串長度選擇算法：單字符走char_scan，短模式串走首尾字符SIMD過濾，
+    // 中等長度走pair_horspool，更長的走Two-Way。
+    // 自定義Traits時短模式串按首字符定位後用Traits::compare校驗，其餘走Two-Way。
+    template <typename CharT, typename Traits>
+    struct string_search
+    {
+        typedef std::size_t size_type;
+
+        // 不大於此長度的模式串不建表
+        static const size_type short_needle = 16;
+
+        static const CharT* find(const CharT* h, size_type n, const CharT* s, size_type m)
+        {
+            if (m == 0) return h;
+            if (n < m) return NULLPTR;
+            if (m == 1) return char_scan<CharT, Traits>::find(h, n, s[0]);
+            if (m <= short_needle || n - m < 4 * short_needle) return _find_short(h, n, s, m);
+            return two_way<CharT, Traits>(s, m).find(h, n);
+        }
+
+        static const CharT* _find_short(const CharT* h, size_type n, const CharT* s, size_type m)
+        {
+            const CharT* last = h + (n - m);
+            while (h <= last)
+            {
+                h = char_scan<CharT, Traits>::find(h, static_cast<size_type>(last - h) + 1, s[0]);
+                if (h == NULLPTR) return NULLPTR;
+                if (Traits::compare(h + 1, s + 1, m - 1) == 0) return h;
+                ++h;
+            }
+            return NULLPTR;
+        }
+    };
+
+    template <typename CharT>
+    struct string_search<CharT, std::char_traits<CharT> >
+    {
+        typedef std::size_t size_type;
+
+        static const size_type short_needle = 12;
+
+        static const CharT* find(const CharT* h, size_type n, const CharT* s, size_type m)
+        {
+            if (m == 0) return h;
+            if (n < m) return NULLPTR;
+            if (m == 1) return char_scan<CharT, std::char_traits<CharT> >::find(h, n, s[0]);
+            if (m <= short_needle || n - m < 4 * short_needle) return simd::search_first_last(h, n, s, m);
+            if (m <= pair_horspool<CharT>::max_size) return pair_horspool<CharT>(s, m).find(h, n);
+            return two_way<CharT, std::char_traits<CharT> >(s, m).find(h, n);
+        }
+    };
+
+    // 逆向子串查找，返回[h, h + n)中最後一個匹配的位置。單字符走char_scan（memrchr），
+    // 短模式串走逆向的首尾字符SIMD過濾，長模式串走逆向Two-Way。
+    template <typename CharT, typename Traits>
+    struct string_rsearch
+    {
+        typedef std::size_t size_type;
+
+        static const size_type short_needle = string_search<CharT, Traits>::short_needle;
+
+        static const CharT* rfind(const CharT* h, size_type n, const CharT* s, size_type m)
+        {
+            if (m == 0) return h + n;
+            if (n < m) return NULLPTR;
+            if (m == 1) return char_scan<CharT, Traits>::rfind(h, n, s[0]);
+            if (m <= short_needle || n - m < 4 * short_needle) return _rfind_short(h, n, s, m);
+            return two_way<CharT, Traits, true>(s, m).find(h, n);
+        }
+
+        static const CharT* _rfind_short(const CharT* h, size_type n, const CharT* s, size_type m)
+        {
+            return _short<is_std_char_traits<CharT, Traits>::value, 0>::rfind(h, n, s, m);
+        }
+
+    private:
+        template <bool StdTraits, int Dummy>
+        struct _short
+        {
+            static const CharT* rfind(const CharT* h, size_type n, const CharT* s, size_type m)
+            {
+                size_type k = n - m + 1;
+                while (k > 0)
+                {
+                    const CharT* p = char_scan<CharT, Traits>::rfind(h, k, s[0]);
+                    if (p == NULLPTR) return NULLPTR;
+                    if (Traits::compare(p + 1, s + 1, m - 1) == 0) return p;
+                    k = static_cast<size_type>(p - h);
+                }
+                return NULLPTR;
+            }
+        };
+
+        template <int Dummy>
+        struct _short<true, Dummy>
+        {
+            static const CharT* rfind(const CharT* h, size_type n, const CharT* s, size_type m)
+            {
+                return simd::rsearch_anchor(h, n, s, m, 0, m - 1);
+            }
+        };
+    };
+}
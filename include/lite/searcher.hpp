@@ -0,0 +1,190 @@
+#pragma once
+#include <cstddef> // std::size_t
+#include <new>     // placement new
+#include <utility> // std::pair
+#include "string_view.hpp"
+#include "search.hpp"
+
+namespace lite
+{
+    // 預編譯的子串查找器：構造時選好算法並建好跳躍表和錨點，之後可對任意多個文本重複查找。
+    // 不持有模式串的內存，模式串必須比searcher活得久。沒有指針指向自身，可以隨意複製，
+    // const成員函數可在多個線程裏同時調用。兩張跳躍表共用一塊存儲，只構造選中的那個算法。
+    // 也可作爲C++17的searcher傳給std::search，此時迭代器必須是連續的。
+    template < typename CharT, typename Traits = std::char_traits<CharT> >
+    class searcher
+    {
+    public:
+        typedef basic_string_view<CharT, Traits> view_type;
+        typedef typename view_type::size_type size_type;
+
+        searcher()
+            : m_kind(kind_empty), m_anchor1(0), m_anchor2(0)
+        {
+        }
+
+        explicit searcher(view_type needle)
+            : m_needle(needle), m_kind(kind_empty), m_anchor1(0), m_anchor2(0)
+        {
+            const size_type m = needle.size();
+            const bool std_traits = is_std_char_traits<CharT, Traits>::value;
+            if (m == 0)
+            {
+                m_kind = kind_empty;
+            }
+            else if (m == 1)
+            {
+                m_kind = kind_char;
+            }
+            else if (m <= string_search<CharT, Traits>::short_needle)
+            {
+                m_kind = kind_short;
+                if (std_traits)
+                {
+                    rare_anchors(needle.data(), m, m_anchor1, m_anchor2);
+                }
+            }
+            else if (std_traits && m <= pair_horspool<CharT>::max_size)
+            {
+                m_kind = kind_horspool;
+                new (&m_horspool) pair_horspool<CharT>(needle.data(), m);
+            }
+            else
+            {
+                m_kind = kind_two_way;
+                new (&m_two_way) two_way<CharT, Traits>(needle.data(), m);
+            }
+        }
+
+        view_type needle() const
+        {
+            return m_needle;
+        }
+
+        // 返回第一個不早於pos的匹配位置，找不到返回npos
+        size_type find(view_type haystack, size_type pos = 0) const
+        {
+            if (pos > haystack.size()) return view_type::_npos();
+
+            const CharT* h = haystack.data() + pos;
+            const CharT* p = _find(h, haystack.size() - pos);
+            if (p == NULLPTR) return view_type::_npos();
+
+            return p - haystack.data();
+        }
+
+        bool contains(view_type haystack) const
+        {
+            return find(haystack) != view_type::_npos();
+        }
+
+        // 依次把每個不重疊的匹配位置寫到out，返回寫完後的out
+        template <typename OutputIt>
+        OutputIt find_all(view_type haystack, OutputIt out) const
+        {
+            const size_type step = m_needle.empty() ? 1 : m_needle.size();
+            for (size_type pos = find(haystack); pos != view_type::_npos(); pos = find(haystack, pos + step))
+            {
+                *out = pos;
+                ++out;
+            }
+            return out;
+        }
+
+        // 不重疊的匹配個數
+        size_type count(view_type haystack) const
+        {
+            const size_type step = m_needle.empty() ? 1 : m_needle.size();
+            size_type result = 0;
+            for (size_type pos = find(haystack); pos != view_type::_npos(); pos = find(haystack, pos + step))
+            {
+                ++result;
+            }
+            return result;
+        }
+
+        // std::search(first, last, searcher)
+        template <typename RandomIt>
+        std::pair<RandomIt, RandomIt> operator()(RandomIt first, RandomIt last) const
+        {
+            if (first == last)
+            {
+                return m_needle.empty()
+                    ? std::pair<RandomIt, RandomIt>(first, first)
+                    : std::pair<RandomIt, RandomIt>(last, last);
+            }
+
+            const CharT* h = &*first;
+            const CharT* p = _find(h, static_cast<size_type>(last - first));
+            if (p == NULLPTR) return std::pair<RandomIt, RandomIt>(last, last);
+
+            RandomIt it = first + (p - h);
+            return std::pair<RandomIt, RandomIt>(it, it + m_needle.size());
+        }
+
+    private:
+        enum kind
+        {
+            kind_empty,
+            kind_char,
+            kind_short,
+            kind_horspool,
+            kind_two_way
+        };
+
+        const CharT* _find(const CharT* h, size_type n) const
+        {
+            const CharT* s = m_needle.data();
+            const size_type m = m_needle.size();
+            if (n < m) return NULLPTR;
+
+            switch (m_kind)
+            {
+            case kind_empty:
+                return h;
+            case kind_char:
+                return char_scan<CharT, Traits>::find(h, n, s[0]);
+            case kind_short:
+                return _find_short(h, n);
+            case kind_horspool:
+                return m_horspool.find(h, n);
+            default:
+                return m_two_way.find(h, n);
+            }
+        }
+
+        const CharT* _find_short(const CharT* h, size_type n) const
+        {
+            return short_search<is_std_char_traits<CharT, Traits>::value, 0>::find(*this, h, n);
+        }
+
+        template <bool StdTraits, int Dummy>
+        struct short_search
+        {
+            static const CharT* find(const searcher& self, const CharT* h, size_type n)
+            {
+                return string_search<CharT, Traits>::_find_short(h, n, self.m_needle.data(), self.m_needle.size());
+            }
+        };
+
+        template <int Dummy>
+        struct short_search<true, Dummy>
+        {
+            static const CharT* find(const searcher& self, const CharT* h, size_type n)
+            {
+                return simd::search_anchor(h, n, self.m_needle.data(), self.m_needle.size(), self.m_anchor1, self.m_anchor2);
+            }
+        };
+
+        view_type m_needle;
+        kind m_kind;
+        size_type m_anchor1;
+        size_type m_anchor2;
+        // 都是平凡可複製、平凡析構的，按m_kind使用其中之一
+        union
+        {
+            pair_horspool<CharT> m_horspool;
+            two_way<CharT, Traits> m_two_way;
+        };
+    };
+}
@@ -0,0 +1,524 @@
+#pragma once
+#include <cstddef> // std::size_t
+#include <cstring> // std::memchr
+#include <cwchar>  // std::wmemchr
+#include <string>  // std::char_traits
+#include "macro.hpp"
+
+#if defined(__AVX2__)
+#  define LITE_AVX2 1
+#endif
+
+#if defined(__SSSE3__) || defined(LITE_AVX2)
+#  define LITE_SSSE3 1
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  define LITE_SSE2 1
+#endif
+
+#if defined(__PCLMUL__)
+#  define LITE_PCLMUL 1
+#endif
+
+#if defined(LITE_AVX2)
+#  include <immintrin.h>
+#elif defined(LITE_SSSE3)
+#  include <tmmintrin.h>
+#elif defined(LITE_SSE2)
+#  include <emmintrin.h>
+#endif
+
+#if defined(LITE_PCLMUL) && !defined(LITE_AVX2)
+#  include <wmmintrin.h>
+#endif
+
+#if defined(_MSC_VER)
+#  include <intrin.h>
+#endif
+
+namespace lite
+{
+    namespace simd
+    {
+        // 最低位的1的位置，x不能爲0
+        inline unsigned ctz(unsigned x)
+        {
+#if defined(_MSC_VER)
+            unsigned long i;
+            _BitScanForward(&i, x);
+            return static_cast<unsigned>(i);
+#else
+            return static_cast<unsigned>(__builtin_ctz(x));
+#endif
+        }
+
+        // 最高位的1的位置，x不能爲0
+        inline unsigned bsr(unsigned x)
+        {
+#if defined(_MSC_VER)
+            unsigned long i;
+            _BitScanReverse(&i, x);
+            return static_cast<unsigned>(i);
+#else
+            return 31u - static_cast<unsigned>(__builtin_clz(x));
+#endif
+        }
+
+        // 64位版本，x不能爲0
+        inline unsigned ctz64(unsigned long long x)
+        {
+#if defined(_MSC_VER) && defined(_M_X64)
+            unsigned long i;
+            _BitScanForward64(&i, x);
+            return static_cast<unsigned>(i);
+#elif defined(_MSC_VER)
+            unsigned lo = static_cast<unsigned>(x);
+            return lo != 0 ? ctz(lo) : 32u + ctz(static_cast<unsigned>(x >> 32));
+#else
+            return static_cast<unsigned>(__builtin_ctzll(x));
+#endif
+        }
+
+        // 64×64→128位乘法：a得到低64位，b得到高64位。可在常量表達式中使用
+        CONSTEXPR14 void mul128(unsigned long long& a, unsigned long long& b)
+        {
+#if defined(__SIZEOF_INT128__)
+            unsigned __int128 r = a;
+            r *= b;
+            a = static_cast<unsigned long long>(r);
+            b = static_cast<unsigned long long>(r >> 64);
+#else
+#  if defined(_MSC_VER) && defined(_M_X64)
+            if (!LITE_IS_CONSTANT_EVALUATED())
+            {
+                a = _umul128(a, b, &b);
+                return;
+            }
+#  endif
+            typedef unsigned long long u64;
+            u64 ha = a >> 32, hb = b >> 32, la = static_cast<unsigned>(a), lb = static_cast<unsigned>(b);
+            u64 rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+            u64 t = rl + (rm0 << 32);
+            u64 c = t < rl;
+            u64 lo = t + (rm1 << 32);
+            c += lo < t;
+            u64 hi = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+            a = lo;
+            b = hi;
+#endif
+        }
+
+        // 1的個數
+        inline unsigned popcount(unsigned x)
+        {
+#if defined(_MSC_VER)
+            x = x - ((x >> 1) & 0x55555555u);
+            x = (x & 0x33333333u) + ((x >> 2) & 0x33333333u);
+            return (((x + (x >> 4)) & 0x0F0F0F0Fu) * 0x01010101u) >> 24;
+#else
+            return static_cast<unsigned>(__builtin_popcount(x));
+#endif
+        }
+
+        // 前綴異或：結果的第i位是x的第0到i位的異或。用於由引號位置求引號內的區域
+        inline unsigned long long prefix_xor(unsigned long long x)
+        {
+#if defined(LITE_PCLMUL) && (defined(__x86_64__) || defined(_M_X64))
+            __m128i r = _mm_clmulepi64_si128(_mm_set_epi64x(0, static_cast<long long>(x)), _mm_set1_epi8(-1), 0);
+            return static_cast<unsigned long long>(_mm_cvtsi128_si64(r));
+#else
+            x ^= x << 1;
+            x ^= x << 2;
+            x ^= x << 4;
+            x ^= x << 8;
+            x ^= x << 16;
+            x ^= x << 32;
+            return x;
+#endif
+        }
+
+        inline unsigned long long load64(const unsigned char* p)
+        {
+            unsigned long long v;
+            std::memcpy(&v, p, 8);
+            return v;
+        }
+
+        inline unsigned load32(const unsigned char* p)
+        {
+            unsigned v;
+            std::memcpy(&v, p, 4);
+            return v;
+        }
+
+        inline bool little_endian()
+        {
+#if defined(__BYTE_ORDER__) && defined(__ORDER_BIG_ENDIAN__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+            return false;
+#else
+            return true;
+#endif
+        }
+
+        // n個字節是否相同。不超過16字節時用兩次重疊的讀取，不調用memcmp
+        inline bool equal(const void* a, const void* b, std::size_t n)
+        {
+            const unsigned char* x = static_cast<const unsigned char*>(a);
+            const unsigned char* y = static_cast<const unsigned char*>(b);
+            if (n > 16) return std::memcmp(x, y, n) == 0;
+            if (n >= 8) return ((load64(x) ^ load64(y)) | (load64(x + n - 8) ^ load64(y + n - 8))) == 0;
+            if (n >= 4) return ((load32(x) ^ load32(y)) | (load32(x + n - 4) ^ load32(y + n - 4))) == 0;
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                if (x[i] != y[i]) return false;
+            }
+            return true;
+        }
+
+        // 第一個不同字節的下標，全部相同時返回n
+        inline std::size_t mismatch(const void* a, const void* b, std::size_t n)
+        {
+            const unsigned char* x = static_cast<const unsigned char*>(a);
+            const unsigned char* y = static_cast<const unsigned char*>(b);
+            std::size_t i = 0;
+#if defined(LITE_AVX2)
+            for (; i + 32 <= n; i += 32)
+            {
+                __m256i e = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(x + i)),
+                                              _mm256_loadu_si256(reinterpret_cast<const __m256i*>(y + i)));
+                unsigned mask = ~static_cast<unsigned>(_mm256_movemask_epi8(e));
+                if (mask != 0) return i + ctz(mask);
+            }
+#endif
+#if defined(LITE_SSE2)
+            for (; i + 16 <= n; i += 16)
+            {
+                __m128i e = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(x + i)),
+                                           _mm_loadu_si128(reinterpret_cast<const __m128i*>(y + i)));
+                unsigned mask = ~static_cast<unsigned>(_mm_movemask_epi8(e)) & 0xFFFF;
+                if (mask != 0) return i + ctz(mask);
+            }
+#endif
+            if (little_endian())
+            {
+                for (; i + 8 <= n; i += 8)
+                {
+                    unsigned long long d = load64(x + i) ^ load64(y + i);
+                    if (d != 0) return i + ctz64(d) / 8;
+                }
+            }
+            for (; i < n; ++i)
+            {
+                if (x[i] != y[i]) return i;
+            }
+            return n;
+        }
+
+        // 按元素寬度選擇無符號類型和比較指令
+        template <std::size_t Width>
+        struct lane;
+
+        template <>
+        struct lane<1>
+        {
+            typedef unsigned char type;
+#if defined(LITE_SSE2)
+            static __m128i set1(type c) { return _mm_set1_epi8(static_cast<char>(c)); }
+            static __m128i cmpeq(__m128i a, __m128i b) { return _mm_cmpeq_epi8(a, b); }
+#endif
+#if defined(LITE_AVX2)
+            static __m256i set1_256(type c) { return _mm256_set1_epi8(static_cast<char>(c)); }
+            static __m256i cmpeq(__m256i a, __m256i b) { return _mm256_cmpeq_epi8(a, b); }
+#endif
+        };
+
+        template <>
+        struct lane<2>
+        {
+            typedef unsigned short type;
+#if defined(LITE_SSE2)
+            static __m128i set1(type c) { return _mm_set1_epi16(static_cast<short>(c)); }
+            static __m128i cmpeq(__m128i a, __m128i b) { return _mm_cmpeq_epi16(a, b); }
+#endif
+#if defined(LITE_AVX2)
+            static __m256i set1_256(type c) { return _mm256_set1_epi16(static_cast<short>(c)); }
+            static __m256i cmpeq(__m256i a, __m256i b) { return _mm256_cmpeq_epi16(a, b); }
+#endif
+        };
+
+        template <>
+        struct lane<4>
+        {
+            typedef unsigned int type;
+#if defined(LITE_SSE2)
+            static __m128i set1(type c) { return _mm_set1_epi32(static_cast<int>(c)); }
+            static __m128i cmpeq(__m128i a, __m128i b) { return _mm_cmpeq_epi32(a, b); }
+#endif
+#if defined(LITE_AVX2)
+            static __m256i set1_256(type c) { return _mm256_set1_epi32(static_cast<int>(c)); }
+            static __m256i cmpeq(__m256i a, __m256i b) { return _mm256_cmpeq_epi32(a, b); }
+#endif
+        };
+
+        // 單元素掃描，返回指向匹配元素的指針，找不到返回NULLPTR
+        template <typename T>
+        struct scan
+        {
+            static const std::size_t Width = sizeof(T);
+            typedef lane<Width> L;
+            typedef T type;
+
+            static const type* find(const type* p, std::size_t n, type c)
+            {
+#if defined(LITE_AVX2)
+                const std::size_t step32 = 32 / Width;
+                const __m256i v32 = L::set1_256(static_cast<typename L::type>(c));
+                for (; n >= 2 * step32; n -= 2 * step32, p += 2 * step32)
+                {
+                    __m256i m0 = L::cmpeq(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)), v32);
+                    __m256i m1 = L::cmpeq(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + step32)), v32);
+                    if (!_mm256_testz_si256(_mm256_or_si256(m0, m1), _mm256_or_si256(m0, m1)))
+                    {
+                        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(m0));
+                        if (mask != 0) return p + ctz(mask) / Width;
+                        mask = static_cast<unsigned>(_mm256_movemask_epi8(m1));
+                        return p + step32 + ctz(mask) / Width;
+                    }
+                }
+                for (; n >= step32; n -= step32, p += step32)
+                {
+                    __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+                    unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(L::cmpeq(x, v32)));
+                    if (mask != 0) return p + ctz(mask) / Width;
+                }
+#endif
+#if defined(LITE_SSE2)
+                const std::size_t step16 = 16 / Width;
+                const __m128i v16 = L::set1(static_cast<typename L::type>(c));
+                for (; n >= 4 * step16; n -= 4 * step16, p += 4 * step16)
+                {
+                    __m128i m0 = L::cmpeq(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)), v16);
+                    __m128i m1 = L::cmpeq(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + step16)), v16);
+                    __m128i m2 = L::cmpeq(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 2 * step16)), v16);
+                    __m128i m3 = L::cmpeq(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 3 * step16)), v16);
+                    if (_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(m0, m1), _mm_or_si128(m2, m3))) != 0)
+                    {
+                        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(m0))
+                            | static_cast<unsigned>(_mm_movemask_epi8(m1)) << 16;
+                        if (mask != 0) return p + ctz(mask) / Width;
+                        mask = static_cast<unsigned>(_mm_movemask_epi8(m2))
+                            | static_cast<unsigned>(_mm_movemask_epi8(m3)) << 16;
+                        return p + 2 * step16 + ctz(mask) / Width;
+                    }
+                }
+                for (; n >= step16; n -= step16, p += step16)
+                {
+                    __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+                    unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(L::cmpeq(x, v16)));
+                    if (mask != 0) return p + ctz(mask) / Width;
+                }
+#endif
+                for (const type* e = p + n; p != e; ++p)
+                {
+                    if (*p == c) return p;
+                }
+                return NULLPTR;
+            }
+
+            static const type* rfind(const type* p, std::size_t n, type c)
+            {
+#if defined(LITE_AVX2)
+                const std::size_t step32 = 32 / Width;
+                const __m256i v32 = L::set1_256(static_cast<typename L::type>(c));
+                while (n >= 2 * step32)
+                {
+                    n -= 2 * step32;
+                    __m256i m0 = L::cmpeq(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + n)), v32);
+                    __m256i m1 = L::cmpeq(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + n + step32)), v32);
+                    if (!_mm256_testz_si256(_mm256_or_si256(m0, m1), _mm256_or_si256(m0, m1)))
+                    {
+                        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(m1));
+                        if (mask != 0) return p + n + step32 + bsr(mask) / Width;
+                        mask = static_cast<unsigned>(_mm256_movemask_epi8(m0));
+                        return p + n + bsr(mask) / Width;
+                    }
+                }
+                while (n >= step32)
+                {
+                    n -= step32;
+                    __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + n));
+                    unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(L::cmpeq(x, v32)));
+                    if (mask != 0) return p + n + bsr(mask) / Width;
+                }
+#endif
+#if defined(LITE_SSE2)
+                const std::size_t step16 = 16 / Width;
+                const __m128i v16 = L::set1(static_cast<typename L::type>(c));
+                while (n >= 4 * step16)
+                {
+                    n -= 4 * step16;
+                    __m128i m0 = L::cmpeq(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + n)), v16);
+                    __m128i m1 = L::cmpeq(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + n + step16)), v16);
+                    __m128i m2 = L::cmpeq(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + n + 2 * step16)), v16);
+                    __m128i m3 = L::cmpeq(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + n + 3 * step16)), v16);
+                    if (_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(m0, m1), _mm_or_si128(m2, m3))) != 0)
+                    {
+                        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(m2))
+                            | static_cast<unsigned>(_mm_movemask_epi8(m3)) << 16;
+                        if (mask != 0) return p + n + 2 * step16 + bsr(mask) / Width;
+                        mask = static_cast<unsigned>(_mm_movemask_epi8(m0))
+                            | static_cast<unsigned>(_mm_movemask_epi8(m1)) << 16;
+                        return p + n + bsr(mask) / Width;
+                    }
+                }
+                while (n >= step16)
+                {
+                    n -= step16;
+                    __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + n));
+                    unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(L::cmpeq(x, v16)));
+                    if (mask != 0) return p + n + bsr(mask) / Width;
+                }
+#endif
+                while (n > 0)
+                {
+                    --n;
+                    if (p[n] == c) return p + n;
+                }
+                return NULLPTR;
+            }
+        };
+
+#if defined(__GLIBC__) || !defined(LITE_SSE2)
+        // glibc的memchr/memrchr在運行時按CPU選擇AVX2/EVEX實現，比編譯期選定的內核更快；
+        // 沒有SIMD時也交給memchr
+        template <>
+        inline const char* scan<char>::find(const char* p, std::size_t n, char c)
+        {
+            if (n == 0) return NULLPTR; // p可能是空指針
+            return static_cast<const char*>(std::memchr(p, static_cast<unsigned char>(c), n));
+        }
+#endif
+
+#if defined(__GLIBC__)
+        template <>
+        inline const wchar_t* scan<wchar_t>::find(const wchar_t* p, std::size_t n, wchar_t c)
+        {
+            if (n == 0) return NULLPTR;
+            return std::wmemchr(p, c, n);
+        }
+#endif
+
+        // Traits::compare是否已經是libc的向量化實現（memcmp、glibc的wmemcmp）
+        template <typename CharT>
+        struct libc_compare
+        {
+            static const bool value = sizeof(CharT) == 1;
+        };
+
+#if defined(__GLIBC__)
+        template <>
+        struct libc_compare<wchar_t>
+        {
+            static const bool value = true;
+        };
+#endif
+
+        // 查找時候選位置的整體校驗：memcmp/wmemcmp已經向量化時直接用，否則按字節比較
+        template <typename CharT>
+        inline bool verify(const CharT* a, const CharT* b, std::size_t n)
+        {
+            if (libc_compare<CharT>::value) return std::char_traits<CharT>::compare(a, b, n) == 0;
+            return equal(a, b, n * sizeof(CharT));
+        }
+
+#if defined(__GLIBC__) && defined(_GNU_SOURCE)
+        template <>
+        inline const char* scan<char>::rfind(const char* p, std::size_t n, char c)
+        {
+            if (n == 0) return NULLPTR;
+            return static_cast<const char*>(::memrchr(p, static_cast<unsigned char>(c), n));
+        }
+#endif
+    }
+
+    // 單字符查找。Traits爲std::char_traits時走simd::scan，否則退回Traits::find和Traits::eq
+    template <typename CharT, typename Traits>
+    struct char_scan
+    {
+        static const CharT* find(const CharT* p, std::size_t n, CharT c)
+        {
+            return Traits::find(p, n, c);
+        }
+
+        static const CharT* rfind(const CharT* p, std::size_t n, CharT c)
+        {
+            while (n > 0)
+            {
+                --n;
+                if (Traits::eq(p[n], c)) return p + n;
+            }
+            return NULLPTR;
+        }
+    };
+
+    template <typename CharT>
+    struct char_scan<CharT, std::char_traits<CharT> >
+    {
+        static const CharT* find(const CharT* p, std::size_t n, CharT c)
+        {
+            return simd::scan<CharT>::find(p, n, c);
+        }
+
+        static const CharT* rfind(const CharT* p, std::size_t n, CharT c)
+        {
+            return simd::scan<CharT>::rfind(p, n, c);
+        }
+    };
+
+    // 逐元素比較。Traits爲std::char_traits時相等就是字節相同，走simd::equal和simd::mismatch
+    template <typename CharT, typename Traits>
+    struct char_compare
+    {
+        static bool equal(const CharT* a, const CharT* b, std::size_t n)
+        {
+            return mismatch(a, b, n) == n;
+        }
+
+        static std::size_t mismatch(const CharT* a, const CharT* b, std::size_t n)
+        {
+            std::size_t i = 0;
+            while (i < n && Traits::eq(a[i], b[i])) ++i;
+            return i;
+        }
+
+        static int compare(const CharT* a, const CharT* b, std::size_t n)
+        {
+            return Traits::compare(a, b, n);
+        }
+    };
+
+    template <typename CharT>
+    struct char_compare<CharT, std::char_traits<CharT> >
+    {
+        static bool equal(const CharT* a, const CharT* b, std::size_t n)
+        {
+            return simd::equal(a, b, n * sizeof(CharT));
+        }
+
+        static std::size_t mismatch(const CharT* a, const CharT* b, std::size_t n)
+        {
+            return simd::mismatch(a, b, n * sizeof(CharT)) / sizeof(CharT);
+        }
+
+        // char交給memcmp，glibc的wchar_t交給wmemcmp。其他寬字符的Traits::compare是逐個比較的循環，
+        // 先按字節找到第一個不同的元素，再比較這一個元素
+        static int compare(const CharT* a, const CharT* b, std::size_t n)
+        {
+            if (simd::libc_compare<CharT>::value) return std::char_traits<CharT>::compare(a, b, n);
+            const std::size_t i = mismatch(a, b, n);
+            if (i == n) return 0;
+            return std::char_traits<CharT>::lt(a[i], b[i]) ? -1 : 1;
+        }
+    };
+}
@@ -0,0 +1,403 @@
+#pragma once
+#include <cstddef>  // std::size_t
+#include <iterator> // std::forward_iterator_tag
+#include "macro.hpp"
+#include "string_view.hpp"
+#include "searcher.hpp"
+#include "char_set.hpp"
+
+#if __cplusplus >= 202002L
+#  include <ranges> // std::ranges::enable_view
+#endif
+
+namespace lite
+{
+    enum split_mode
+    {
+        keep_empty, // 相鄰分隔符之間、首尾的空串也是一個元素
+        skip_empty  // 跳過空串
+    };
+
+    // 分隔符策略：find在[p, p + n)中找下一個分隔符，返回其起點並把長度寫到len，找不到返回NULLPTR
+
+    // 單個字符
+    template <typename CharT, typename Traits>
+    struct split_by_char
+    {
+        explicit split_by_char(CharT c = CharT()) : m_c(c) {}
+
+        const CharT* find(const CharT* p, std::size_t n, std::size_t& len) const
+        {
+            len = 1;
+            return char_scan<CharT, Traits>::find(p, n, m_c);
+        }
+
+    private:
+        CharT m_c;
+    };
+
+    // 子串，空子串不分割。不持有子串的內存
+    template <typename CharT, typename Traits>
+    struct split_by_string
+    {
+        split_by_string() {}
+        explicit split_by_string(basic_string_view<CharT, Traits> s) : m_searcher(s) {}
+
+        const CharT* find(const CharT* p, std::size_t n, std::size_t& len) const
+        {
+            len = m_searcher.needle().size();
+            if (len == 0) return NULLPTR;
+
+            std::size_t i = m_searcher.find(basic_string_view<CharT, Traits>(p, n));
+            return i == basic_string_view<CharT, Traits>::_npos() ? NULLPTR : p + i;
+        }
+
+    private:
+        searcher<CharT, Traits> m_searcher;
+    };
+
+    // 集合中的任一字符（同find_first_of）。不持有集合的內存
+    template <typename CharT, typename Traits>
+    struct split_by_any
+    {
+        split_by_any() {}
+        explicit split_by_any(basic_string_view<CharT, Traits> s) : m_set(s) {}
+
+        const CharT* find(const CharT* p, std::size_t n, std::size_t& len) const
+        {
+            len = 1;
+            return char_set_scan<CharT, Traits>::template find_first<true>(p, n, m_set.data(), m_set.size());
+        }
+
+    private:
+        basic_string_view<CharT, Traits> m_set;
+    };
+
+    // char的集合只在構造時建一次char_set
+    template <>
+    struct split_by_any< char, std::char_traits<char> >
+    {
+        split_by_any() {}
+        explicit split_by_any(string_view s) : m_set(s) {}
+
+        const char* find(const char* p, std::size_t n, std::size_t& len) const
+        {
+            len = 1;
+            return m_set.find_first(p, n);
+        }
+
+    private:
+        char_set m_set;
+    };
+
+    // 滿足謂詞的字符
+    template <typename CharT, typename Pred>
+    struct split_by_pred
+    {
+        split_by_pred() {}
+        explicit split_by_pred(Pred pred) : m_pred(pred) {}
+
+        const CharT* find(const CharT* p, std::size_t n, std::size_t& len) const
+        {
+            len = 1;
+            for (const CharT* e = p + n; p != e; ++p)
+            {
+                if (m_pred(*p)) return p;
+            }
+            return NULLPTR;
+        }
+
+    private:
+        Pred m_pred;
+    };
+
+    // 按分隔符惰性切分的範圍，每次遞增找一個分隔符，不分配內存。
+    // 元素是指向原串的basic_string_view，原串必須比split_view及其迭代器活得久。
+    // max_splits限制最多切幾次，之後剩下的部分整個作爲最後一個元素（skip_empty時空的剩餘部分仍被跳過）。
+    template <typename CharT, typename Traits, typename Delimiter>
+    class basic_split_view
+    {
+    public:
+        typedef basic_string_view<CharT, Traits> view_type;
+        typedef typename view_type::size_type size_type;
+
+        class iterator
+        {
+        public:
+            typedef std::forward_iterator_tag iterator_category;
+            typedef view_type value_type;
+            typedef std::ptrdiff_t difference_type;
+            typedef const view_type* pointer;
+            typedef view_type reference;
+
+            iterator() : m_owner(NULLPTR), m_next(NULLPTR), m_splits(0), m_last(true), m_end(true) {}
+
+            reference operator*() const { return m_token; }
+            pointer operator->() const { return &m_token; }
+
+            iterator& operator++()
+            {
+                do
+                {
+                    _advance();
+                } while (!m_end && m_owner->m_mode == skip_empty && m_token.empty());
+                return *this;
+            }
+
+            iterator operator++(int)
+            {
+                iterator temp = *this;
+                ++*this;
+                return temp;
+            }
+
+            friend bool operator==(const iterator& a, const iterator& b)
+            {
+                return a.m_end == b.m_end && (a.m_end || a.m_token.data() == b.m_token.data());
+            }
+
+            friend bool operator!=(const iterator& a, const iterator& b)
+            {
+                return !(a == b);
+            }
+
+        private:
+            friend class basic_split_view;
+
+            explicit iterator(const basic_split_view* owner)
+                : m_owner(owner), m_next(owner->m_input.data()), m_splits(0), m_last(false), m_end(false)
+            {
+                ++*this;
+            }
+
+            void _advance()
+            {
+                if (m_last)
+                {
+                    m_end = true;
+                    return;
+                }
+
+                const CharT* last = m_owner->m_input.data() + m_owner->m_input.size();
+                const size_type rest = static_cast<size_type>(last - m_next);
+                size_type len = 0;
+                const CharT* p = m_splits < m_owner->m_max_splits ? m_owner->m_delimiter.find(m_next, rest, len) : NULLPTR;
+                if (p == NULLPTR)
+                {
+                    m_token = view_type(m_next, rest);
+                    m_last = true;
+                }
+                else
+                {
+                    m_token = view_type(m_next, static_cast<size_type>(p - m_next));
+                    m_next = p + len;
+                    ++m_splits;
+                }
+            }
+
+            const basic_split_view* m_owner;
+            view_type m_token;
+            const CharT* m_next;
+            size_type m_splits;
+            bool m_last; // 當前元素是最後一個
+            bool m_end;
+        };
+
+        typedef iterator const_iterator;
+
+        basic_split_view()
+            : m_mode(keep_empty), m_max_splits(view_type::_npos())
+        {
+        }
+
+        basic_split_view(view_type input, const Delimiter& delimiter, split_mode mode = keep_empty, size_type max_splits = view_type::_npos())
+            : m_input(input), m_delimiter(delimiter), m_mode(mode), m_max_splits(max_splits)
+        {
+        }
+
+        iterator begin() const
+        {
+            return iterator(this);
+        }
+
+        iterator end() const
+        {
+            return iterator();
+        }
+
+        view_type input() const
+        {
+            return m_input;
+        }
+
+    private:
+        view_type m_input;
+        Delimiter m_delimiter;
+        split_mode m_mode;
+        size_type m_max_splits;
+    };
+
+    template <typename T>
+    struct split_identity
+    {
+        typedef T type;
+    };
+
+    // 按單個字符切分
+    template <typename CharT, typename Traits>
+    basic_split_view< CharT, Traits, split_by_char<CharT, Traits> >
+    split(basic_string_view<CharT, Traits> input, CharT delimiter, split_mode mode = keep_empty, std::size_t max_splits = std::size_t(-1))
+    {
+        return basic_split_view< CharT, Traits, split_by_char<CharT, Traits> >(
+            input, split_by_char<CharT, Traits>(delimiter), mode, max_splits);
+    }
+
+    // 按子串切分
+    template <typename CharT, typename Traits>
+    basic_split_view< CharT, Traits, split_by_string<CharT, Traits> >
+    split(basic_string_view<CharT, Traits> input, typename split_identity< basic_string_view<CharT, Traits> >::type delimiter,
+          split_mode mode = keep_empty, std::size_t max_splits = std::size_t(-1))
+    {
+        return basic_split_view< CharT, Traits, split_by_string<CharT, Traits> >(
+            input, split_by_string<CharT, Traits>(delimiter), mode, max_splits);
+    }
+
+    // 按集合中的任一字符切分
+    template <typename CharT, typename Traits>
+    basic_split_view< CharT, Traits, split_by_any<CharT, Traits> >
+    split_any(basic_string_view<CharT, Traits> input, typename split_identity< basic_string_view<CharT, Traits> >::type delimiters,
+              split_mode mode = keep_empty, std::size_t max_splits = std::size_t(-1))
+    {
+        return basic_split_view< CharT, Traits, split_by_any<CharT, Traits> >(
+            input, split_by_any<CharT, Traits>(delimiters), mode, max_splits);
+    }
+
+    // 按滿足pred的字符切分
+    template <typename CharT, typename Traits, typename Pred>
+    basic_split_view< CharT, Traits, split_by_pred<CharT, Pred> >
+    split_if(basic_string_view<CharT, Traits> input, Pred pred, split_mode mode = keep_empty, std::size_t max_splits = std::size_t(-1))
+    {
+        return basic_split_view< CharT, Traits, split_by_pred<CharT, Pred> >(
+            input, split_by_pred<CharT, Pred>(pred), mode, max_splits);
+    }
+
+    // 按行切分：元素不含換行符，末尾的換行不產生空行，空輸入沒有行。\r\n的\r保留在行尾
+    template <typename CharT, typename Traits>
+    class basic_line_view
+    {
+    public:
+        typedef basic_string_view<CharT, Traits> view_type;
+        typedef typename view_type::size_type size_type;
+
+        class iterator
+        {
+        public:
+            typedef std::forward_iterator_tag iterator_category;
+            typedef view_type value_type;
+            typedef std::ptrdiff_t difference_type;
+            typedef const view_type* pointer;
+            typedef view_type reference;
+
+            iterator() : m_next(NULLPTR), m_last(NULLPTR), m_end(true) {}
+
+            reference operator*() const { return m_line; }
+            pointer operator->() const { return &m_line; }
+
+            iterator& operator++()
+            {
+                if (m_next == m_last)
+                {
+                    m_end = true;
+                    return *this;
+                }
+
+                const size_type rest = static_cast<size_type>(m_last - m_next);
+                const CharT* p = char_scan<CharT, Traits>::find(m_next, rest, CharT('\n'));
+                if (p == NULLPTR)
+                {
+                    m_line = view_type(m_next, rest);
+                    m_next = m_last;
+                }
+                else
+                {
+                    m_line = view_type(m_next, static_cast<size_type>(p - m_next));
+                    m_next = p + 1;
+                }
+                return *this;
+            }
+
+            iterator operator++(int)
+            {
+                iterator temp = *this;
+                ++*this;
+                return temp;
+            }
+
+            friend bool operator==(const iterator& a, const iterator& b)
+            {
+                return a.m_end == b.m_end && (a.m_end || a.m_line.data() == b.m_line.data());
+            }
+
+            friend bool operator!=(const iterator& a, const iterator& b)
+            {
+                return !(a == b);
+            }
+
+        private:
+            friend class basic_line_view;
+
+            explicit iterator(view_type input)
+                : m_next(input.data()), m_last(input.data() + input.size()), m_end(false)
+            {
+                ++*this;
+            }
+
+            view_type m_line;
+            const CharT* m_next;
+            const CharT* m_last;
+            bool m_end;
+        };
+
+        typedef iterator const_iterator;
+
+        basic_line_view() {}
+        explicit basic_line_view(view_type input) : m_input(input) {}
+
+        iterator begin() const
+        {
+            return iterator(m_input);
+        }
+
+        iterator end() const
+        {
+            return iterator();
+        }
+
+    private:
+        view_type m_input;
+    };
+
+    template <typename CharT, typename Traits>
+    basic_line_view<CharT, Traits> lines(basic_string_view<CharT, Traits> input)
+    {
+        return basic_line_view<CharT, Traits>(input);
+    }
+}
+
+#if __cplusplus >= 202002L
+namespace std
+{
+    namespace ranges
+    {
+        template <typename CharT, typename Traits, typename Delimiter>
+        inline constexpr bool enable_view< lite::basic_split_view<CharT, Traits, Delimiter> > = true;
+
+        template <typename CharT, typename Traits>
+        inline constexpr bool enable_view< lite::basic_line_view<CharT, Traits> > = true;
+
+        // 行迭代器不引用basic_line_view本身
+        template <typename CharT, typename Traits>
+        inline constexpr bool enable_borrowed_range< lite::basic_line_view<CharT, Traits> > = true;
+    }
+}
+#endif
@@ -0,0 +1,342 @@
+#pragma once
+#include <cassert>   // assert
+#include <cstddef>   // std::size_t
+#include <stdexcept> // std::invalid_argument, std::out_of_range
+#include <tuple>     // std::tuple, std::get, std::forward_as_tuple
+#include <utility>   // std::forward
+#include "macro.hpp"
+#include "string_view.hpp"
+#include "hash.hpp"
+
+namespace lite
+{
+    // 不小於N的2的冪
+    template <std::size_t N, std::size_t P = 1, bool Done = (P >= N)>
+    struct static_pow2
+    {
+        static const std::size_t value = static_pow2<N, P * 2>::value;
+    };
+
+    template <std::size_t N, std::size_t P>
+    struct static_pow2<N, P, true>
+    {
+        static const std::size_t value = P;
+    };
+
+    template <typename V>
+    struct static_map_entry
+    {
+        string_view key;
+        V value;
+    };
+
+    // 鍵集合固定的查找表，C++14起可以在編譯期構造。
+    // 構造時用hash-and-displace找一個完美散列：鍵按散列分到bucket_count()個桶，
+    // 從大桶開始，爲每個桶找一個位移，使桶裏的鍵都落到空槽上。
+    // 查找只算一次散列，讀一個位移和一個槽，再比較一次鍵。
+    // 條目按構造時的順序保存，index_of返回這個順序中的位置。鍵只保存視圖，通常是字面量。
+    // 鍵重複時拋出std::invalid_argument（編譯期構造時表現爲編譯錯誤）。
+    template <typename V, std::size_t N>
+    class static_map
+    {
+    public:
+        typedef std::size_t size_type;
+        typedef static_map_entry<V> value_type;
+
+        // 槽數：不小於N * 5 / 4的2的冪，負載不超過0.8
+        static const size_type slot_count = static_pow2<N + N / 4 + 1>::value;
+
+        // 桶數：平均每個桶兩個鍵
+        static const size_type buckets = static_pow2<N / 2 + 1>::value;
+
+        CONSTEXPR14 explicit static_map(const value_type (&entries)[N])
+            : m_keys(), m_values(), m_slots(), m_displacement(), m_seed(0)
+        {
+            for (size_type i = 0; i < N; ++i)
+            {
+                m_keys[i] = entries[i].key;
+                m_values[i] = entries[i].value;
+            }
+            _build();
+        }
+
+        // 只有鍵，值是鍵的位置。V要能從size_type構造，一般通過make_static_keys使用
+        CONSTEXPR14 explicit static_map(const string_view (&keys)[N])
+            : m_keys(), m_values(), m_slots(), m_displacement(), m_seed(0)
+        {
+            for (size_type i = 0; i < N; ++i)
+            {
+                m_keys[i] = keys[i];
+                m_values[i] = V(i);
+            }
+            _build();
+        }
+
+        static CONSTEXPR size_type table_size()
+        {
+            return slot_count;
+        }
+
+        static CONSTEXPR size_type bucket_count()
+        {
+            return buckets;
+        }
+
+        static CONSTEXPR size_type _npos()
+        {
+            return size_type(-1);
+        }
+
+        CONSTEXPR size_type size() const NOEXCEPT
+        {
+            return N;
+        }
+
+        CONSTEXPR bool empty() const NOEXCEPT
+        {
+            return N == 0;
+        }
+
+        // 構造順序中的第i個鍵和值
+        CONSTEXPR14 string_view key(size_type i) const
+        {
+            assert(i < N);
+            return m_keys[i];
+        }
+
+        CONSTEXPR14 const V& value(size_type i) const
+        {
+            assert(i < N);
+            return m_values[i];
+        }
+
+        // 鍵在構造順序中的位置，沒有時返回_npos()
+        CONSTEXPR14 size_type index_of(string_view key) const
+        {
+            if (N == 0) return _npos();
+
+            const unsigned long long h = hash<string_view>(m_seed)(key);
+            const unsigned slot = m_slots[_slot(h, m_displacement[_bucket(h)])];
+            if (slot == 0 || m_keys[slot - 1] != key) return _npos();
+            return slot - 1;
+        }
+
+        CONSTEXPR14 const V* find(string_view key) const
+        {
+            const size_type i = index_of(key);
+            return i == _npos() ? NULLPTR : &m_values[i];
+        }
+
+        CONSTEXPR14 bool contains(string_view key) const
+        {
+            return index_of(key) != _npos();
+        }
+
+        CONSTEXPR14 const V& at(string_view key) const
+        {
+            const size_type i = index_of(key);
+            if (i == _npos()) throw std::out_of_range("lite::static_map::at");
+            return m_values[i];
+        }
+
+        // 沒有時返回otherwise
+        CONSTEXPR14 V get(string_view key, const V& otherwise) const
+        {
+            const size_type i = index_of(key);
+            return i == _npos() ? otherwise : m_values[i];
+        }
+
+    private:
+        typedef unsigned long long u64;
+
+        enum
+        {
+            max_displacement = 1 << 12, // 一個桶試這麼多位移還不行就換種子
+            max_seed = 64
+        };
+
+        static CONSTEXPR size_type _bucket(u64 h)
+        {
+            return static_cast<size_type>((h * 0x9e3779b97f4a7c15ull) >> 40) & (buckets - 1);
+        }
+
+        static CONSTEXPR14 size_type _slot(u64 h, unsigned d)
+        {
+            u64 x = h ^ (d * 0x9e3779b97f4a7c15ull);
+            x ^= x >> 32;
+            x *= 0xd6e8feb86659fd93ull;
+            x ^= x >> 32;
+            return static_cast<size_type>(x) & (slot_count - 1);
+        }
+
+        CONSTEXPR14 void _build()
+        {
+            for (u64 seed = 0; seed < max_seed; ++seed)
+            {
+                m_seed = seed;
+                if (_try_build()) return;
+            }
+            throw std::invalid_argument("lite::static_map: no perfect hash found");
+        }
+
+        // 用當前種子建表，某個桶找不到位移時返回false
+        CONSTEXPR14 bool _try_build()
+        {
+            u64 hashes[N == 0 ? 1 : N] = {};
+            size_type start[buckets + 1] = {}; // 按桶排序後每個桶的起點
+            size_type members[N == 0 ? 1 : N] = {};
+            size_type largest = 0;
+
+            for (size_type i = 0; i < N; ++i)
+            {
+                hashes[i] = hash<string_view>(m_seed)(m_keys[i]);
+                ++start[_bucket(hashes[i]) + 1];
+            }
+            for (size_type b = 0; b < buckets; ++b)
+            {
+                if (start[b + 1] > largest) largest = start[b + 1];
+                start[b + 1] += start[b];
+            }
+            size_type fill[buckets + 1] = {};
+            for (size_type i = 0; i < N; ++i)
+            {
+                const size_type b = _bucket(hashes[i]);
+                members[start[b] + fill[b]++] = i;
+            }
+
+            for (size_type s = 0; s < slot_count; ++s) m_slots[s] = 0;
+            for (size_type b = 0; b < buckets; ++b) m_displacement[b] = 0;
+
+            // 大桶先放，空槽多時更容易找到位移
+            for (size_type count = largest; count > 0; --count)
+            {
+                for (size_type b = 0; b < buckets; ++b)
+                {
+                    if (start[b + 1] - start[b] != count) continue;
+
+                    unsigned d = 0;
+                    while (!_fits(hashes, members + start[b], count, d))
+                    {
+                        if (++d == max_displacement)
+                        {
+                            _check_duplicates(hashes, members + start[b], count);
+                            return false;
+                        }
+                    }
+                    m_displacement[b] = d;
+                    for (size_type k = 0; k < count; ++k)
+                    {
+                        const size_type i = members[start[b] + k];
+                        m_slots[_slot(hashes[i], d)] = static_cast<unsigned>(i + 1);
+                    }
+                }
+            }
+            return true;
+        }
+
+        // 桶裏的鍵用位移d是否都落到互不相同的空槽
+        CONSTEXPR14 bool _fits(const u64* hashes, const size_type* members, size_type count, unsigned d) const
+        {
+            for (size_type k = 0; k < count; ++k)
+            {
+                const size_type s = _slot(hashes[members[k]], d);
+                if (m_slots[s] != 0) return false;
+                for (size_type j = 0; j < k; ++j)
+                {
+                    if (_slot(hashes[members[j]], d) == s) return false;
+                }
+            }
+            return true;
+        }
+
+        // 散列完全相同的兩個鍵不可能分開，相等時就是重複的鍵
+        CONSTEXPR14 void _check_duplicates(const u64* hashes, const size_type* members, size_type count) const
+        {
+            for (size_type k = 0; k < count; ++k)
+            {
+                for (size_type j = 0; j < k; ++j)
+                {
+                    if (hashes[members[j]] == hashes[members[k]] && m_keys[members[j]] == m_keys[members[k]])
+                    {
+                        throw std::invalid_argument("lite::static_map: duplicate key");
+                    }
+                }
+            }
+        }
+
+        string_view m_keys[N == 0 ? 1 : N];
+        V m_values[N == 0 ? 1 : N];
+        unsigned m_slots[slot_count]; // 條目下標加一，0表示空槽
+        unsigned m_displacement[buckets];
+        u64 m_seed;
+    };
+
+    // constexpr auto methods = lite::make_static_map<int>({ { "GET", 1 }, { "POST", 2 } });
+    template <typename V, std::size_t N>
+    CONSTEXPR14 static_map<V, N> make_static_map(const static_map_entry<V> (&entries)[N])
+    {
+        return static_map<V, N>(entries);
+    }
+
+    // 只有鍵，值是鍵的位置，適合配合static_switch或switch語句
+    template <std::size_t N>
+    CONSTEXPR14 static_map<std::size_t, N> make_static_keys(const string_view (&keys)[N])
+    {
+        return static_map<std::size_t, N>(keys);
+    }
+
+#if __cplusplus >= 201103L
+    // 0, 1, ..., N - 1
+    template <std::size_t... I>
+    struct static_indices
+    {
+    };
+
+    template <std::size_t N, std::size_t... I>
+    struct static_make_indices : static_make_indices<N - 1, N - 1, I...>
+    {
+    };
+
+    template <std::size_t... I>
+    struct static_make_indices<0, I...>
+    {
+        typedef static_indices<I...> type;
+    };
+
+    // 每個處理函數一個跳板，按下標查函數指針表後調用一次，不逐個比較
+    template <typename R, typename Tuple>
+    struct static_switch_case
+    {
+        typedef R (*thunk)(Tuple&);
+
+        template <std::size_t I>
+        static R invoke(Tuple& handlers)
+        {
+            return std::get<I>(handlers)();
+        }
+
+        template <std::size_t... I>
+        static R call(std::size_t i, Tuple& handlers, static_indices<I...>)
+        {
+            static const thunk table[] = { &invoke<I>... };
+            return table[i](handlers);
+        }
+    };
+
+    // 按鍵在map中的位置調用對應的處理函數，最後一個處理函數處理不在map中的鍵。
+    // 處理函數不帶參數，返回類型相同：
+    // lite::static_switch(methods, method, [] { return get(); }, [] { return post(); }, [] { return bad_request(); });
+    template <typename V, std::size_t N, typename... Handlers>
+    auto static_switch(const static_map<V, N>& map, string_view key, Handlers&&... handlers)
+        -> decltype(std::get<0>(std::forward_as_tuple(handlers...))())
+    {
+        static_assert(sizeof...(Handlers) == N + 1, "lite::static_switch: one handler per key plus a default");
+        typedef decltype(std::get<0>(std::forward_as_tuple(handlers...))()) result_type;
+        typedef std::tuple<Handlers&&...> tuple_type;
+
+        const std::size_t i = map.index_of(key);
+        tuple_type all(std::forward<Handlers>(handlers)...);
+        return static_switch_case<result_type, tuple_type>::call(i < N ? i : N, all, typename static_make_indices<N + 1>::type());
+    }
+#endif
+}
@@ -0,0 +1,303 @@
+#pragma once
+#include <cstddef> // std::size_t
+#include <cstdio>  // std::snprintf
+#include <string>  // std::string
+#include "macro.hpp"
+#include "simd.hpp"
+
+#if LITE_STATS
+#  include <algorithm> // std::find
+#  include <atomic>    // std::atomic
+#  include <mutex>     // std::mutex, std::lock_guard
+#  include <vector>    // std::vector
+#endif
+
+// 記錄一次調用。LITE_STATS爲0時展開爲空，參數不求值；常量求值時不記錄
+#if LITE_STATS
+#  define LITE_STATS_RECORD(f, haystack, needle, bytes, matched) \
+       (LITE_IS_CONSTANT_EVALUATED() ? (void)0 : \
+        ::lite::stats::record(::lite::stats::family::f, (haystack), (needle), (bytes), (matched)))
+#else
+#  define LITE_STATS_RECORD(f, haystack, needle, bytes, matched) ((void)0)
+#endif
+
+namespace lite
+{
+    // basic_string_view的熱路徑統計，編譯時用LITE_STATS打開。
+    // 每個線程寫自己的計數器（thread_local，不加鎖），snapshot()和dump()時合併所有線程；
+    // 線程結束時它的計數併入總數。只記錄走到掃描核心的調用，位置越界等直接返回的不算。
+    namespace stats
+    {
+        struct family
+        {
+            enum type
+            {
+                find,
+                rfind,
+                find_first_of,
+                find_last_of,
+                find_first_not_of,
+                find_last_not_of,
+                compare,
+                copy,
+                count
+            };
+        };
+
+        struct format
+        {
+            enum type
+            {
+                text,
+                json
+            };
+        };
+
+        static const bool enabled = LITE_STATS != 0;
+
+        // 長度直方圖：0號桶是0，k號桶是[2^(k-1), 2^k)，最後一個桶是2^32及以上
+        static const std::size_t buckets = 34;
+
+        inline std::size_t bucket(std::size_t n)
+        {
+            if (n == 0) return 0;
+            if ((static_cast<unsigned long long>(n) >> 32) != 0) return buckets - 1;
+            return simd::bsr(static_cast<unsigned>(n)) + 1;
+        }
+
+        inline const char* family_name(family::type f)
+        {
+            static const char* const names[family::count] = {
+                "find", "rfind", "find_first_of", "find_last_of",
+                "find_first_not_of", "find_last_not_of", "compare", "copy"
+            };
+            return names[f];
+        }
+
+        template <typename T>
+        struct basic_counters
+        {
+            T calls;
+            T bytes;   // 掃描過的字節數
+            T matches; // 找到（compare爲相等）的次數
+            T haystack[buckets];
+            T needle[buckets];
+        };
+
+        typedef basic_counters<unsigned long long> counters;
+
+        struct report
+        {
+            counters families[family::count];
+
+            report()
+            {
+                for (std::size_t f = 0; f < family::count; ++f)
+                {
+                    counters& c = families[f];
+                    c.calls = c.bytes = c.matches = 0;
+                    for (std::size_t i = 0; i < buckets; ++i) c.haystack[i] = c.needle[i] = 0;
+                }
+            }
+
+            const counters& operator[](family::type f) const { return families[f]; }
+        };
+
+#if LITE_STATS
+        // 只有本線程寫，用relaxed的load/store代替加鎖的讀改寫，別的線程讀到的是某個時刻的值
+        typedef basic_counters<std::atomic<unsigned long long> > _atomic_counters;
+
+        inline void _bump(std::atomic<unsigned long long>& a, unsigned long long n)
+        {
+            a.store(a.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+        }
+
+        inline void _add(counters& to, const _atomic_counters& from)
+        {
+            to.calls += from.calls.load(std::memory_order_relaxed);
+            to.bytes += from.bytes.load(std::memory_order_relaxed);
+            to.matches += from.matches.load(std::memory_order_relaxed);
+            for (std::size_t i = 0; i < buckets; ++i)
+            {
+                to.haystack[i] += from.haystack[i].load(std::memory_order_relaxed);
+                to.needle[i] += from.needle[i].load(std::memory_order_relaxed);
+            }
+        }
+
+        inline void _clear(_atomic_counters& c)
+        {
+            c.calls.store(0, std::memory_order_relaxed);
+            c.bytes.store(0, std::memory_order_relaxed);
+            c.matches.store(0, std::memory_order_relaxed);
+            for (std::size_t i = 0; i < buckets; ++i)
+            {
+                c.haystack[i].store(0, std::memory_order_relaxed);
+                c.needle[i].store(0, std::memory_order_relaxed);
+            }
+        }
+
+        struct _local;
+
+        // 所有活着的線程的計數器，加上已經結束的線程併入的總數
+        struct _registry
+        {
+            std::mutex m_lock;
+            std::vector<_local*> m_live;
+            report m_retired;
+        };
+
+        inline _registry& _global()
+        {
+            static _registry r;
+            return r;
+        }
+
+        struct _local
+        {
+            _atomic_counters m_families[family::count];
+
+            _local()
+            {
+                for (std::size_t f = 0; f < family::count; ++f) _clear(m_families[f]);
+                _registry& r = _global();
+                std::lock_guard<std::mutex> guard(r.m_lock);
+                r.m_live.push_back(this);
+            }
+
+            ~_local()
+            {
+                _registry& r = _global();
+                std::lock_guard<std::mutex> guard(r.m_lock);
+                for (std::size_t f = 0; f < family::count; ++f) _add(r.m_retired.families[f], m_families[f]);
+                r.m_live.erase(std::find(r.m_live.begin(), r.m_live.end(), this));
+            }
+
+        private:
+            _local(const _local&);
+            _local& operator=(const _local&);
+        };
+
+        inline _local& _this_thread()
+        {
+            static thread_local _local local;
+            return local;
+        }
+
+        inline void record(family::type f, std::size_t haystack, std::size_t needle, std::size_t bytes, bool matched)
+        {
+            _atomic_counters& c = _this_thread().m_families[f];
+            _bump(c.calls, 1);
+            _bump(c.bytes, bytes);
+            if (matched) _bump(c.matches, 1);
+            _bump(c.haystack[bucket(haystack)], 1);
+            _bump(c.needle[bucket(needle)], 1);
+        }
+
+        // 合併所有線程的計數
+        inline report snapshot()
+        {
+            _registry& r = _global();
+            std::lock_guard<std::mutex> guard(r.m_lock);
+            report result = r.m_retired;
+            for (std::size_t i = 0; i < r.m_live.size(); ++i)
+            {
+                for (std::size_t f = 0; f < family::count; ++f) _add(result.families[f], r.m_live[i]->m_families[f]);
+            }
+            return result;
+        }
+
+        // 清零所有線程的計數。別的線程同時在記錄時，它那一次可能不會被清掉
+        inline void reset()
+        {
+            _registry& r = _global();
+            std::lock_guard<std::mutex> guard(r.m_lock);
+            r.m_retired = report();
+            for (std::size_t i = 0; i < r.m_live.size(); ++i)
+            {
+                for (std::size_t f = 0; f < family::count; ++f) _clear(r.m_live[i]->m_families[f]);
+            }
+        }
+#else
+        inline report snapshot()
+        {
+            return report();
+        }
+
+        inline void reset()
+        {
+        }
+#endif
+
+        inline void _append(std::string& out, const char* fmt, unsigned long long a, unsigned long long b = 0, unsigned long long c = 0)
+        {
+            char buf[128];
+            int n = std::snprintf(buf, sizeof(buf), fmt, a, b, c);
+            if (n > 0) out.append(buf, static_cast<std::size_t>(n) < sizeof(buf) ? static_cast<std::size_t>(n) : sizeof(buf) - 1);
+        }
+
+        // 文本格式只列出被調用過的成員和非空的桶，桶用“下界-上界”表示
+        inline void _histogram_text(std::string& out, const char* label, const unsigned long long* h)
+        {
+            out += "  ";
+            out += label;
+            for (std::size_t i = 0; i < buckets; ++i)
+            {
+                if (h[i] == 0) continue;
+                if (i == 0) _append(out, "  0: %llu", h[i]);
+                else if (i == buckets - 1) _append(out, "  %llu+: %llu", 1ULL << (i - 1), h[i]);
+                else if (i == 1) _append(out, "  1: %llu", h[i]);
+                else _append(out, "  %llu-%llu: %llu", 1ULL << (i - 1), (1ULL << i) - 1, h[i]);
+            }
+            out += '\n';
+        }
+
+        inline void _histogram_json(std::string& out, const unsigned long long* h)
+        {
+            out += '[';
+            for (std::size_t i = 0; i < buckets; ++i)
+            {
+                _append(out, i == 0 ? "%llu" : ", %llu", h[i]);
+            }
+            out += ']';
+        }
+
+        // 統計報告。JSON中每個直方圖是buckets個數的數組，下標含義見bucket()
+        inline std::string dump(format::type f = format::text)
+        {
+            const report r = snapshot();
+            std::string out;
+            if (f == format::json)
+            {
+                out += enabled ? "{\"enabled\": true, \"families\": {" : "{\"enabled\": false, \"families\": {";
+                for (std::size_t i = 0; i < family::count; ++i)
+                {
+                    const counters& c = r.families[i];
+                    out += i == 0 ? "\n  \"" : ",\n  \"";
+                    out += family_name(static_cast<family::type>(i));
+                    _append(out, "\": {\"calls\": %llu, \"bytes\": %llu, \"matches\": %llu, \"haystack\": ", c.calls, c.bytes, c.matches);
+                    _histogram_json(out, c.haystack);
+                    out += ", \"needle\": ";
+                    _histogram_json(out, c.needle);
+                    out += '}';
+                }
+                out += "\n}}\n";
+                return out;
+            }
+
+            if (!enabled) return "lite::stats: disabled (define LITE_STATS=1)\n";
+            for (std::size_t i = 0; i < family::count; ++i)
+            {
+                const counters& c = r.families[i];
+                if (c.calls == 0) continue;
+                const std::string name = family_name(static_cast<family::type>(i));
+                out += name;
+                out.append(name.size() < 18 ? 18 - name.size() : 1, ' ');
+                _append(out, "calls %llu  bytes %llu  matches %llu\n", c.calls, c.bytes, c.matches);
+                _histogram_text(out, "haystack", c.haystack);
+                _histogram_text(out, "needle  ", c.needle);
+            }
+            if (out.empty()) out = "lite::stats: no calls recorded\n";
+            return out;
+        }
+    }
+}
@@ -1,9 +1,19 @@
 ﻿#pragma once
 #include <string>    // std::char_traits
 #include <cassert>   // std::assert
+#include <limits>    // std::numeric_limits
 #include <stdexcept> // std::out_of_range
+#include <type_traits> // std::enable_if, std::is_same
+#if __cplusplus >= 202002L
+#  include <compare> // std::strong_ordering, std::weak_ordering
+#endif
+#include "macro.hpp"
 #include "algorithm.hpp"
 #include "iterator.hpp"
+#include "simd.hpp"
+#include "search.hpp"
+#include "char_set.hpp"
+#include "stats.hpp"
 
 namespace lite
 {
@@ -18,7 +28,11 @@ namespace lite
         typedef CharT& reference;
         typedef const CharT& const_reference;
 
+#if LITE_CONTIGUOUS_ITERATOR
+        typedef const CharT* const_iterator;
+#else
         typedef LegacyRandomAccessIterator< basic_string_view_const_iterator<CharT> > const_iterator;
+#endif
         typedef const_iterator iterator;
         typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
         typedef const_reverse_iterator reverse_iterator;
@@ -27,41 +41,34 @@ namespace lite
 
         // basic_string_view<CharT, Traits>::basic_string_view
 
-        CONSTEXPR basic_string_view() NOEXCEPT // 1
-        {
-            _init(NULLPTR, 0);
-        }
+        // 複製構造、賦值、析構用編譯器生成的：字面類型，可以在常量表達式中使用，並且可平凡複製
 
-        CONSTEXPR basic_string_view(const basic_string_view& other) NOEXCEPT // 2
+        CONSTEXPR basic_string_view() NOEXCEPT // 1
+            : m_data(NULLPTR), m_size(0)
         {
-            _init(other.data(), other.size());
         }
 
         CONSTEXPR basic_string_view(const CharT* s, size_type count) // 3
+            : m_data(s), m_size(count)
         {
-            _init(s, count);
         }
 
-        CONSTEXPR basic_string_view(const CharT* s) // 4
+        // 4：只接受指針。數組由下面的構造函數處理，否則字面量會優先匹配這個非模板版本
+        template <typename Pointer, typename = typename std::enable_if<
+                                        std::is_same<Pointer, const CharT*>::value || std::is_same<Pointer, CharT*>::value>::type>
+        CONSTEXPR basic_string_view(const Pointer& s) // 4
+            : m_data(s), m_size(_length(s))
         {
-            _init(s, Traits::length(s));
         }
 
-        ~basic_string_view()
+        // 字符數組（包括字面量）：長度是第一個空字符之前的部分，沒有空字符時是整個數組。
+        // 掃描以N爲界，字面量的長度在編譯期就能算出
+        template <size_type N>
+        CONSTEXPR basic_string_view(const CharT (&s)[N])
+            : m_data(s), m_size(_length(s, N))
         {
         }
 
-        // basic_string_view<CharT, Traits>::operator=
-
-        CONSTEXPR basic_string_view& operator=(const basic_string_view& view) NOEXCEPT
-        {
-            if (this != &view)
-            {
-                _init(view.data(), view.size());
-            }
-            return *this;
-        }
-
         // static CONSTEXPR size_type npos()
         // {
         //     return size_type(-1);
@@ -76,7 +83,7 @@ namespace lite
 
         CONSTEXPR const_iterator cbegin() const NOEXCEPT
         {
-            return data();
+            return begin();
         }
 
         // basic_string_view<CharT,Traits>::end, basic_string_view<CharT,Traits>::cend
@@ -88,7 +95,7 @@ namespace lite
 
         CONSTEXPR const_iterator cend() const NOEXCEPT
         {
-            return data() + size();
+            return end();
         }
 
         // basic_string_view<CharT,Traits>::rbegin, basic_string_view<CharT,Traits>::crbegin
@@ -100,7 +107,7 @@ namespace lite
 
         CONSTEXPR const_reverse_iterator crbegin() const NOEXCEPT
         {
-            return begin() + size() - 1;
+            return rbegin();
         }
 
         // basic_string_view<CharT,Traits>::rend, basic_string_view<CharT,Traits>::crend
@@ -117,7 +124,7 @@ namespace lite
 
         // basic_string_view<CharT,Traits>::operator[]
 
-        CONSTEXPR const_reference operator[](size_type pos) const
+        CONSTEXPR14 const_reference operator[](size_type pos) const
         {
             assert(pos < size());
             return *(data() + pos);
@@ -125,7 +132,7 @@ namespace lite
 
         // basic_string_view<CharT,Traits>::at
 
-        CONSTEXPR const_reference at(size_type pos) const
+        CONSTEXPR14 const_reference at(size_type pos) const
         {
             if (pos >= size())
             {
@@ -136,7 +143,7 @@ namespace lite
 
         // basic_string_view<CharT,Traits>::front
 
-        CONSTEXPR const_reference front() const
+        CONSTEXPR14 const_reference front() const
         {
             assert(!empty());
             return (*this)[0];
@@ -144,7 +151,7 @@ namespace lite
 
         // basic_string_view<CharT,Traits>::back
 
-        CONSTEXPR const_reference back() const
+        CONSTEXPR14 const_reference back() const
         {
             assert(!empty());
             return (*this)[size() - 1];
@@ -173,7 +180,7 @@ namespace lite
 
         CONSTEXPR size_type max_size() const NOEXCEPT
         {
-            return 0xFFFFFFFF;
+            return static_cast<size_type>(std::numeric_limits<difference_type>::max()) / sizeof(CharT);
         }
 
         // basic_string_view<CharT,Traits>::empty
@@ -185,7 +192,7 @@ namespace lite
 
         // basic_string_view<CharT,Traits>::remove_prefix
 
-        CONSTEXPR void remove_prefix(size_type n)
+        CONSTEXPR14 void remove_prefix(size_type n)
         {
             assert(n <= size());
             m_data += n;
@@ -194,7 +201,7 @@ namespace lite
 
         // basic_string_view<CharT,Traits>::remove_suffix
 
-        CONSTEXPR void remove_suffix(size_type n)
+        CONSTEXPR14 void remove_suffix(size_type n)
         {
             assert(n <= size());
             m_size -= n;
@@ -202,15 +209,19 @@ namespace lite
 
         // basic_string_view<CharT,Traits>::swap
 
-        CONSTEXPR void swap(basic_string_view& v) NOEXCEPT
+        CONSTEXPR14 void swap(basic_string_view& v) NOEXCEPT
         {
-            std::swap(m_data, v.m_data);
-            std::swap(m_size, v.m_size);
+            const_pointer d = m_data;
+            size_type n = m_size;
+            m_data = v.m_data;
+            m_size = v.m_size;
+            v.m_data = d;
+            v.m_size = n;
         }
 
         // basic_string_view<CharT,Traits>::copy
 
-        CONSTEXPR size_type copy(CharT* dest, size_type count, size_type pos = 0) const
+        CONSTEXPR14 size_type copy(CharT* dest, size_type count, size_type pos = 0) const
         {
             if (pos > size())
             {
@@ -218,12 +229,13 @@ namespace lite
             }
             size_type rcount = _min(count, size() - pos);
             Traits::copy(dest, data() + pos, rcount);
+            LITE_STATS_RECORD(copy, size() - pos, 0, rcount * sizeof(CharT), false);
             return rcount;
         }
 
         // basic_string_view<CharT,Traits>::substr
 
-        CONSTEXPR basic_string_view substr(size_type pos = 0, size_type count = _npos()) const
+        CONSTEXPR14 basic_string_view substr(size_type pos = 0, size_type count = _npos()) const
         {
             size_type copy_count = 0;
             if (count == _npos())
@@ -239,33 +251,12 @@ namespace lite
 
         // basic_string_view<CharT,Traits>::compare
 
-        CONSTEXPR int compare(basic_string_view v) const NOEXCEPT // 1
+        CONSTEXPR14 int compare(basic_string_view v) const NOEXCEPT // 1
         {
-            size_type rlen = size() < v.size() ? size() : v.size();
-            int c = Traits::compare(data(), v.data(), rlen);
-            if (c < 0)
-            {
-                return -1;
-            }
-            else if (c == 0)
-            {
-                if (size() < v.size())
-                {
-                    return -1;
-                }
-                else if (size() == v.size())
-                {
-                    return 0;
-                }
-                else // if (size() > v.size())
-                {
-                    return 1;
-                }
-            }
-            else
-            {
-                return 1;
-            }
+            int c = _compare(data(), v.data(), _min(size(), v.size()));
+            LITE_STATS_RECORD(compare, size(), v.size(), _min(size(), v.size()) * sizeof(CharT), c == 0 && size() == v.size());
+            if (c != 0) return c < 0 ? -1 : 1;
+            return size() == v.size() ? 0 : (size() < v.size() ? -1 : 1);
         }
 
         CONSTEXPR int compare(
@@ -354,28 +345,30 @@ namespace lite
 
         // basic_string_view<CharT, Traits>::find
 
-        CONSTEXPR size_type find(basic_string_view v, size_type pos = 0) const NOEXCEPT // 1
+        CONSTEXPR14 size_type find(basic_string_view v, size_type pos = 0) const NOEXCEPT // 1
         {
-            if (size() - pos < v.size()) return _npos();
+            if (pos > size() || size() - pos < v.size()) return _npos();
+            if (LITE_IS_CONSTANT_EVALUATED()) return _constant_find(data(), size(), v.data(), v.size(), pos);
 
-            c_iter iter = std::search(this->begin() + pos, end(), v.begin(), v.end());
+            const_pointer p = string_search<CharT, Traits>::find(data() + pos, size() - pos, v.data(), v.size());
+            LITE_STATS_RECORD(find, size() - pos, v.size(), _scanned(data() + pos, size() - pos, p, v.size()), p != NULLPTR);
 
-            if (iter == end()) return _npos();
+            if (p == NULLPTR) return _npos();
 
-            return iter - this->begin();
+            return p - data();
         }
 
-        CONSTEXPR size_type find(CharT ch, size_type pos = 0) const NOEXCEPT // 2
+        CONSTEXPR14 size_type find(CharT ch, size_type pos = 0) const NOEXCEPT // 2
         {
-            if (size() - pos < 1) return _npos();
+            if (pos >= size()) return _npos();
+            if (LITE_IS_CONSTANT_EVALUATED()) return _constant_find(data(), size(), &ch, 1, pos);
 
-            c_iter b = this->begin();
-            c_iter e = this->end();
-            c_iter iter = std::find(b + pos, e, ch);
+            const_pointer p = char_scan<CharT, Traits>::find(data() + pos, size() - pos, ch);
+            LITE_STATS_RECORD(find, size() - pos, 1, _scanned(data() + pos, size() - pos, p, 1), p != NULLPTR);
 
-            if (iter == e) return _npos();
+            if (p == NULLPTR) return _npos();
 
-            return iter - b;
+            return p - data();
         }
 
         CONSTEXPR size_type find(const CharT* s, size_type pos, size_type count) const // 3
@@ -390,22 +383,31 @@ namespace lite
 
         // basic_string_view<CharT,Traits>::rfind
 
-        CONSTEXPR size_type rfind(basic_string_view v, size_type pos = _npos()) const NOEXCEPT // 1
+        CONSTEXPR14 size_type rfind(basic_string_view v, size_type pos = _npos()) const NOEXCEPT // 1
         {
             if (size() < v.size()) return _npos();
 
-            cr_iter rb = this->rbegin();
-            cr_iter re = this->rend();
-            cr_iter iter = std::search(rb+ pos, re, v.rbegin(), v.rend());
+            size_type count = _min(pos, size() - v.size()) + v.size();
+            if (LITE_IS_CONSTANT_EVALUATED()) return _constant_rfind(data(), count, v.data(), v.size());
 
-            if (iter == re) return _npos();
-
-            return size() - (iter - rb) - v.size();
+            const_pointer p = string_rsearch<CharT, Traits>::rfind(data(), count, v.data(), v.size());
+            LITE_STATS_RECORD(rfind, count, v.size(), _rscanned(data(), count, p), p != NULLPTR);
+            return _index(p);
         }
 
-        CONSTEXPR size_type rfind(CharT c, size_type pos = _npos()) const NOEXCEPT // 2
+        CONSTEXPR14 size_type rfind(CharT c, size_type pos = _npos()) const NOEXCEPT // 2
         {
-            return rfind(basic_string_view(&c, 1), pos);
+            if (empty()) return _npos();
+
+            size_type count = _min(pos, size() - 1) + 1;
+            if (LITE_IS_CONSTANT_EVALUATED()) return _constant_rfind(data(), count, &c, 1);
+
+            const_pointer p = char_scan<CharT, Traits>::rfind(data(), count, c);
+            LITE_STATS_RECORD(rfind, count, 1, _rscanned(data(), count, p), p != NULLPTR);
+
+            if (p == NULLPTR) return _npos();
+
+            return p - data();
         }
 
         CONSTEXPR size_type rfind(const CharT* s, size_type pos, size_type count) const // 3
@@ -420,12 +422,17 @@ namespace lite
 
         // basic_string_view<CharT,Traits>::find_first_of
 
-        CONSTEXPR size_type find_first_of(basic_string_view v, size_type pos = 0) const NOEXCEPT // 1
+        CONSTEXPR14 size_type find_first_of(basic_string_view v, size_type pos = 0) const NOEXCEPT // 1
         {
-            return std::find_first_of(begin() + pos, end(), v.begin(), v.end()) - begin();
+            if (pos >= size()) return _npos();
+            if (LITE_IS_CONSTANT_EVALUATED()) return _constant_find_of(data(), pos, size(), v.data(), v.size(), true);
+
+            const_pointer p = char_set_scan<CharT, Traits>::template find_first<true>(data() + pos, size() - pos, v.data(), v.size());
+            LITE_STATS_RECORD(find_first_of, size() - pos, v.size(), _scanned(data() + pos, size() - pos, p, 1), p != NULLPTR);
+            return _index(p);
         }
 
-        CONSTEXPR size_type find_first_of(CharT c, size_type pos = 0) const NOEXCEPT // 2
+        CONSTEXPR14 size_type find_first_of(CharT c, size_type pos = 0) const NOEXCEPT // 2
         {
             return find_first_of(basic_string_view(&c, 1), pos);
         }
@@ -440,19 +447,29 @@ namespace lite
             return find_first_of(basic_string_view(s), pos);
         }
 
+        CONSTEXPR14 size_type find_first_of(const char_set& set, size_type pos = 0) const // lite::char_set, CharT爲char
+        {
+            if (pos >= size()) return _npos();
+
+            const_pointer p = set.find_first(data() + pos, size() - pos);
+            LITE_STATS_RECORD(find_first_of, size() - pos, set.size(), _scanned(data() + pos, size() - pos, p, 1), p != NULLPTR);
+            return _index(p);
+        }
+
         // basic_string_view<CharT,Traits>::find_last_of
 
-        CONSTEXPR size_type find_last_of(basic_string_view v, size_type pos = _npos()) const NOEXCEPT // 1
+        CONSTEXPR14 size_type find_last_of(basic_string_view v, size_type pos = _npos()) const NOEXCEPT // 1
         {
-            c_iter b = this->begin();
-            c_iter e = _end_or(pos);
-            c_iter iter = lite::find_last_of(b, e, v.begin(), v.end());
-            if (iter == b + pos) return _npos();
+            if (empty()) return _npos();
+            if (LITE_IS_CONSTANT_EVALUATED()) return _constant_rfind_of(data(), _min(pos, size() - 1) + 1, v.data(), v.size(), true);
 
-            return iter - b;
+            const size_type count = _min(pos, size() - 1) + 1;
+            const_pointer p = char_set_scan<CharT, Traits>::template find_last<true>(data(), count, v.data(), v.size());
+            LITE_STATS_RECORD(find_last_of, count, v.size(), _rscanned(data(), count, p), p != NULLPTR);
+            return _index(p);
         }
 
-        CONSTEXPR size_type find_last_of(CharT c, size_type pos = _npos()) const NOEXCEPT // 2
+        CONSTEXPR14 size_type find_last_of(CharT c, size_type pos = _npos()) const NOEXCEPT // 2
         {
             return find_last_of(basic_string_view(&c, 1), pos);
         }
@@ -467,16 +484,29 @@ namespace lite
             return find_last_of(basic_string_view(s), pos);
         }
 
+        CONSTEXPR14 size_type find_last_of(const char_set& set, size_type pos = _npos()) const // lite::char_set, CharT爲char
+        {
+            if (empty()) return _npos();
+
+            const size_type count = _min(pos, size() - 1) + 1;
+            const_pointer p = set.find_last(data(), count);
+            LITE_STATS_RECORD(find_last_of, count, set.size(), _rscanned(data(), count, p), p != NULLPTR);
+            return _index(p);
+        }
+
         // basic_string_view<CharT,Traits>::find_first_not_of
 
-        CONSTEXPR size_type find_first_not_of(basic_string_view v, size_type pos = 0) const NOEXCEPT // 1
+        CONSTEXPR14 size_type find_first_not_of(basic_string_view v, size_type pos = 0) const NOEXCEPT // 1
         {
-            Pred<c_iter> pred(v.begin(), v.end());
+            if (pos >= size()) return _npos();
+            if (LITE_IS_CONSTANT_EVALUATED()) return _constant_find_of(data(), pos, size(), v.data(), v.size(), false);
 
-            return std::find_first_of(begin() + pos, end(), v.begin(), v.end(), pred) - this->begin();
+            const_pointer p = char_set_scan<CharT, Traits>::template find_first<false>(data() + pos, size() - pos, v.data(), v.size());
+            LITE_STATS_RECORD(find_first_not_of, size() - pos, v.size(), _scanned(data() + pos, size() - pos, p, 1), p != NULLPTR);
+            return _index(p);
         }
 
-        CONSTEXPR size_type find_first_not_of(CharT c, size_type pos = 0) const NOEXCEPT // 2
+        CONSTEXPR14 size_type find_first_not_of(CharT c, size_type pos = 0) const NOEXCEPT // 2
         {
             return find_first_not_of(basic_string_view(&c, 1), pos);
         }
@@ -491,21 +521,29 @@ namespace lite
             return find_first_not_of(basic_string_view(s), pos);
         }
 
+        CONSTEXPR14 size_type find_first_not_of(const char_set& set, size_type pos = 0) const // lite::char_set, CharT爲char
+        {
+            if (pos >= size()) return _npos();
+
+            const_pointer p = set.find_first_not(data() + pos, size() - pos);
+            LITE_STATS_RECORD(find_first_not_of, size() - pos, set.size(), _scanned(data() + pos, size() - pos, p, 1), p != NULLPTR);
+            return _index(p);
+        }
+
         // basic_string_view<CharT,Traits>::find_last_not_of
 
-        CONSTEXPR size_type find_last_not_of(basic_string_view v, size_type pos = _npos()) const NOEXCEPT // 1
+        CONSTEXPR14 size_type find_last_not_of(basic_string_view v, size_type pos = _npos()) const NOEXCEPT // 1
         {
-            Pred<cr_iter> pred(v.rbegin(), v.rend());
-
-            c_iter b = this->begin();
-            c_iter e = _end_or(pos);
-            c_iter iter = lite::find_last_of(b, e, v.begin(), v.end(), pred);
-            if (iter == e) return _npos();
+            if (empty()) return _npos();
+            if (LITE_IS_CONSTANT_EVALUATED()) return _constant_rfind_of(data(), _min(pos, size() - 1) + 1, v.data(), v.size(), false);
 
-            return iter - b;
+            const size_type count = _min(pos, size() - 1) + 1;
+            const_pointer p = char_set_scan<CharT, Traits>::template find_last<false>(data(), count, v.data(), v.size());
+            LITE_STATS_RECORD(find_last_not_of, count, v.size(), _rscanned(data(), count, p), p != NULLPTR);
+            return _index(p);
         }
 
-        CONSTEXPR size_type find_last_not_of(CharT c, size_type pos = _npos()) const NOEXCEPT // 2
+        CONSTEXPR14 size_type find_last_not_of(CharT c, size_type pos = _npos()) const NOEXCEPT // 2
         {
             return find_last_not_of(basic_string_view(&c, 1), pos);
         }
@@ -515,48 +553,145 @@ namespace lite
             return find_last_not_of(basic_string_view(s, count), pos);
         }
 
-        constexpr size_type find_last_not_of(const CharT* s, size_type pos = _npos()) const // 4
+        CONSTEXPR size_type find_last_not_of(const CharT* s, size_type pos = _npos()) const // 4
         {
             return find_last_not_of(basic_string_view(s), pos);
         }
 
+        CONSTEXPR14 size_type find_last_not_of(const char_set& set, size_type pos = _npos()) const // lite::char_set, CharT爲char
+        {
+            if (empty()) return _npos();
+
+            const size_type count = _min(pos, size() - 1) + 1;
+            const_pointer p = set.find_last_not(data(), count);
+            LITE_STATS_RECORD(find_last_not_of, count, set.size(), _rscanned(data(), count, p), p != NULLPTR);
+            return _index(p);
+        }
+
         static CONSTEXPR size_type _npos()
         {
             return size_type(-1);
         }
 
     private:
-        typedef const_reverse_iterator cr_iter;
-        typedef const_iterator c_iter;
+        static CONSTEXPR size_type _min(const size_type& _a, const size_type& _b)
+        {
+            return _a < _b ? _a : _b;
+        }
 
-        template <typename It>
-        struct Pred
+        CONSTEXPR size_type _index(const_pointer p) const
         {
-            Pred(It _b, It _e) : b(_b), e(_e) {};
-            ~Pred() {};
-            bool operator()(const value_type& a, const value_type&)
+            return p == NULLPTR ? _npos() : static_cast<size_type>(p - data());
+        }
+
+        // 給lite::stats用：從first向後找到p（長度m的匹配）爲止掃描的字節數，沒找到是整個區間
+        static CONSTEXPR size_type _scanned(const_pointer first, size_type n, const_pointer p, size_type m)
+        {
+            return (p == NULLPTR ? n : static_cast<size_type>(p - first) + m) * sizeof(CharT);
+        }
+
+        // 從[first, first + n)的末尾向前找到p爲止掃描的字節數
+        static CONSTEXPR size_type _rscanned(const_pointer first, size_type n, const_pointer p)
+        {
+            return (p == NULLPTR ? n : static_cast<size_type>(first + n - p)) * sizeof(CharT);
+        }
+
+        // 下面的_constant_*是常量求值時用的樸素實現，運行時走Traits和SIMD的版本
+
+        static CONSTEXPR14 size_type _length(const_pointer s)
+        {
+            if (LITE_IS_CONSTANT_EVALUATED())
             {
-                return std::find(b, e, a) == e;
+                size_type n = 0;
+                while (!Traits::eq(s[n], CharT())) ++n;
+                return n;
             }
-        private:
-            It b;
-            It e;
-        };
+            return Traits::length(s);
+        }
 
-        void _init(const_pointer _data, size_type _size)
+        // 最多n個字符中第一個空字符之前的長度
+        static CONSTEXPR14 size_type _length(const_pointer s, size_type n)
         {
-            m_data = _data;
-            m_size = _size;
+            if (LITE_IS_CONSTANT_EVALUATED())
+            {
+                size_type i = 0;
+                while (i < n && !Traits::eq(s[i], CharT())) ++i;
+                return i;
+            }
+            const_pointer p = Traits::find(s, n, CharT());
+            return p == NULLPTR ? n : static_cast<size_type>(p - s);
         }
 
-        size_type _min(const size_type& _a, const size_type& _b) const
+        static CONSTEXPR14 int _compare(const_pointer a, const_pointer b, size_type n)
         {
-            return _a < _b ? _a : _b;
+            if (LITE_IS_CONSTANT_EVALUATED())
+            {
+                for (size_type i = 0; i < n; ++i)
+                {
+                    if (Traits::lt(a[i], b[i])) return -1;
+                    if (Traits::lt(b[i], a[i])) return 1;
+                }
+                return 0;
+            }
+            return char_compare<CharT, Traits>::compare(a, b, n);
+        }
+
+        static CONSTEXPR14 bool _constant_match(const_pointer a, const_pointer b, size_type n)
+        {
+            for (size_type i = 0; i < n; ++i)
+            {
+                if (!Traits::eq(a[i], b[i])) return false;
+            }
+            return true;
+        }
+
+        // [pos, n)中第一個s
+        static CONSTEXPR14 size_type _constant_find(const_pointer p, size_type n, const_pointer s, size_type m, size_type pos)
+        {
+            for (size_type i = pos; i + m <= n; ++i)
+            {
+                if (_constant_match(p + i, s, m)) return i;
+            }
+            return _npos();
+        }
+
+        // [0, n)中最後一個s
+        static CONSTEXPR14 size_type _constant_rfind(const_pointer p, size_type n, const_pointer s, size_type m)
+        {
+            for (size_type i = n - m + 1; i > 0; --i)
+            {
+                if (_constant_match(p + i - 1, s, m)) return i - 1;
+            }
+            return _npos();
         }
 
-        const_iterator _end_or(size_type pos) const
+        static CONSTEXPR14 bool _constant_in(const_pointer s, size_type m, CharT c)
         {
-            return pos == _npos() ? end() : begin() + pos;
+            for (size_type i = 0; i < m; ++i)
+            {
+                if (Traits::eq(s[i], c)) return true;
+            }
+            return false;
+        }
+
+        // [pos, n)中第一個在（in爲false時不在）集合中的字符
+        static CONSTEXPR14 size_type _constant_find_of(const_pointer p, size_type pos, size_type n, const_pointer s, size_type m, bool in)
+        {
+            for (size_type i = pos; i < n; ++i)
+            {
+                if (_constant_in(s, m, p[i]) == in) return i;
+            }
+            return _npos();
+        }
+
+        // [0, n)中最後一個在（in爲false時不在）集合中的字符
+        static CONSTEXPR14 size_type _constant_rfind_of(const_pointer p, size_type n, const_pointer s, size_type m, bool in)
+        {
+            for (size_type i = n; i > 0; --i)
+            {
+                if (_constant_in(s, m, p[i - 1]) == in) return i - 1;
+            }
+            return _npos();
         }
 
         const_pointer m_data;
@@ -564,52 +699,136 @@ namespace lite
     };
 
     typedef basic_string_view<char, std::char_traits<char>> string_view;
-}
+    typedef basic_string_view<wchar_t, std::char_traits<wchar_t>> wstring_view;
+#if __cplusplus >= 201103L
+    typedef basic_string_view<char16_t, std::char_traits<char16_t>> u16string_view;
+    typedef basic_string_view<char32_t, std::char_traits<char32_t>> u32string_view;
+#endif
 
-template <typename CharT, typename Traits>
-CONSTEXPR bool operator==(
-    lite::basic_string_view<CharT, Traits> lhs,
-    lite::basic_string_view<CharT, Traits> rhs) NOEXCEPT
-{
-    return lhs.compare(rhs) == 0;
-}
+    inline char_set::char_set(string_view s)
+    {
+        _clear();
+        insert(s.data(), s.size());
+    }
 
-template <typename CharT, typename Traits>
-CONSTEXPR bool operator!=(
-    const lite::basic_string_view<CharT, Traits> lhs,
-    const lite::basic_string_view<CharT, Traits> rhs) NOEXCEPT
-{
-    return lhs.compare(rhs) != 0;
-}
+#if __cplusplus >= 201103L
+    // using namespace lite::literals;後 "abc"_sv 直接得到長度已知的視圖
+    inline namespace literals
+    {
+        inline namespace string_view_literals
+        {
+            CONSTEXPR string_view operator""_sv(const char* s, std::size_t n) NOEXCEPT
+            {
+                return string_view(s, n);
+            }
 
-template <typename CharT, typename Traits>
-CONSTEXPR bool operator<(
-    lite::basic_string_view<CharT, Traits> lhs,
-    lite::basic_string_view<CharT, Traits> rhs) NOEXCEPT
-{
-    return lhs.compare(rhs) < 0;
-}
+            CONSTEXPR wstring_view operator""_sv(const wchar_t* s, std::size_t n) NOEXCEPT
+            {
+                return wstring_view(s, n);
+            }
 
-template <typename CharT, typename Traits>
-CONSTEXPR bool operator<=(
-    lite::basic_string_view<CharT, Traits> lhs,
-    lite::basic_string_view<CharT, Traits> rhs) NOEXCEPT
-{
-    return lhs.compare(rhs) <= 0;
-}
+            CONSTEXPR u16string_view operator""_sv(const char16_t* s, std::size_t n) NOEXCEPT
+            {
+                return u16string_view(s, n);
+            }
 
-template <typename CharT, typename Traits>
-CONSTEXPR bool operator>(
-    lite::basic_string_view<CharT, Traits> lhs,
-    lite::basic_string_view<CharT, Traits> rhs) NOEXCEPT
-{
-    return lhs.compare(rhs) > 0;
-}
+            CONSTEXPR u32string_view operator""_sv(const char32_t* s, std::size_t n) NOEXCEPT
+            {
+                return u32string_view(s, n);
+            }
+        }
+    }
+#endif
 
-template <typename CharT, typename Traits>
-CONSTEXPR bool operator>=(
-    lite::basic_string_view<CharT, Traits> lhs,
-    lite::basic_string_view<CharT, Traits> rhs) NOEXCEPT
-{
-    return lhs.compare(rhs) >= 0;
+    // 第一個不同字符的下標。一個是另一個的前綴時返回較短的長度，即公共前綴的長度
+    template <typename CharT, typename Traits>
+    CONSTEXPR14 std::size_t mismatch(
+        basic_string_view<CharT, Traits> a,
+        basic_string_view<CharT, Traits> b) NOEXCEPT
+    {
+        const std::size_t n = a.size() < b.size() ? a.size() : b.size();
+        if (LITE_IS_CONSTANT_EVALUATED())
+        {
+            std::size_t i = 0;
+            while (i < n && Traits::eq(a[i], b[i])) ++i;
+            return i;
+        }
+        return char_compare<CharT, Traits>::mismatch(a.data(), b.data(), n);
+    }
+
+    // 相等先比長度，長度不同時不讀內容；不需要三路比較的結果
+    template <typename CharT, typename Traits>
+    CONSTEXPR14 bool operator==(
+        basic_string_view<CharT, Traits> lhs,
+        basic_string_view<CharT, Traits> rhs) NOEXCEPT
+    {
+        if (lhs.size() != rhs.size()) return false;
+        if (LITE_IS_CONSTANT_EVALUATED()) return lhs.compare(rhs) == 0;
+        const bool eq = char_compare<CharT, Traits>::equal(lhs.data(), rhs.data(), lhs.size());
+        LITE_STATS_RECORD(compare, lhs.size(), rhs.size(), lhs.size() * sizeof(CharT), eq);
+        return eq;
+    }
+
+    template <typename CharT, typename Traits>
+    CONSTEXPR14 bool operator!=(
+        const basic_string_view<CharT, Traits> lhs,
+        const basic_string_view<CharT, Traits> rhs) NOEXCEPT
+    {
+        return !(lhs == rhs);
+    }
+
+    template <typename CharT, typename Traits>
+    CONSTEXPR bool operator<(
+        basic_string_view<CharT, Traits> lhs,
+        basic_string_view<CharT, Traits> rhs) NOEXCEPT
+    {
+        return lhs.compare(rhs) < 0;
+    }
+
+    template <typename CharT, typename Traits>
+    CONSTEXPR bool operator<=(
+        basic_string_view<CharT, Traits> lhs,
+        basic_string_view<CharT, Traits> rhs) NOEXCEPT
+    {
+        return lhs.compare(rhs) <= 0;
+    }
+
+    template <typename CharT, typename Traits>
+    CONSTEXPR bool operator>(
+        basic_string_view<CharT, Traits> lhs,
+        basic_string_view<CharT, Traits> rhs) NOEXCEPT
+    {
+        return lhs.compare(rhs) > 0;
+    }
+
+    template <typename CharT, typename Traits>
+    CONSTEXPR bool operator>=(
+        basic_string_view<CharT, Traits> lhs,
+        basic_string_view<CharT, Traits> rhs) NOEXCEPT
+    {
+        return lhs.compare(rhs) >= 0;
+    }
+
+#if __cplusplus >= 202002L && defined(__cpp_lib_three_way_comparison)
+    template <typename Traits, typename = void>
+    struct string_view_ordering
+    {
+        typedef std::weak_ordering type;
+    };
+
+    template <typename Traits>
+    struct string_view_ordering<Traits, std::void_t<typename Traits::comparison_category> >
+    {
+        typedef typename Traits::comparison_category type;
+    };
+
+    // 比較類別取Traits::comparison_category，沒有時是std::weak_ordering（同std::basic_string_view）
+    template <typename CharT, typename Traits>
+    constexpr typename string_view_ordering<Traits>::type operator<=>(
+        basic_string_view<CharT, Traits> lhs,
+        basic_string_view<CharT, Traits> rhs) noexcept
+    {
+        return static_cast<typename string_view_ordering<Traits>::type>(lhs.compare(rhs) <=> 0);
+    }
+#endif
 }
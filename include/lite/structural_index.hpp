@@ -0,0 +1,396 @@
+#pragma once
+#include <cstddef>   // std::size_t
+#include <cstring>   // std::memcpy, std::memset
+#include <iterator>  // std::forward_iterator_tag
+#include <stdexcept> // std::length_error, std::out_of_range
+#include <string>    // std::string
+#include <vector>    // std::vector
+#include "macro.hpp"
+#include "simd.hpp"
+#include "string_view.hpp"
+
+namespace lite
+{
+    // 分隔符分隔的記錄（CSV、TSV）的結構索引。
+    // build()用SIMD每次比較64個字節，得到分隔符、引號、換行的位掩碼；
+    // 引號掩碼做前綴異或得到引號內的區域（轉義的雙引號""一進一出，自然抵消），
+    // 再把引號外的分隔符和換行的偏移寫進一個緊湊的數組。
+    // 之後取第r條記錄的第k個字段只需讀兩個偏移。
+    // 偏移用32位存，輸入不能超過4GiB。索引只保存偏移和輸入的視圖，輸入必須比索引活得久。
+    class structural_index
+    {
+    public:
+        typedef std::size_t size_type;
+        typedef unsigned offset_type;
+
+        class record;
+
+        // 字段。value()去掉兩端的引號，但字段內轉義的""保持原樣，需要時用unescape()
+        class field
+        {
+        public:
+            field() {}
+
+            // 原始內容，包括引號
+            string_view raw() const
+            {
+                return m_raw;
+            }
+
+            bool quoted() const
+            {
+                return m_raw.size() >= 2 && m_raw[0] == m_quote && m_raw[m_raw.size() - 1] == m_quote;
+            }
+
+            string_view value() const
+            {
+                return quoted() ? m_raw.substr(1, m_raw.size() - 2) : m_raw;
+            }
+
+            // 是否有要轉義的""
+            bool escaped() const
+            {
+                if (!quoted()) return false;
+                char q[2] = { m_quote, m_quote };
+                return value().find(string_view(q, 2)) != string_view::_npos();
+            }
+
+            // 把去掉引號、""換成"後的內容追加到out
+            void unescape(std::string& out) const
+            {
+                string_view v = value();
+                const bool q = quoted();
+                for (size_type i = 0; i < v.size(); ++i)
+                {
+                    out += v[i];
+                    if (q && v[i] == m_quote && i + 1 < v.size() && v[i + 1] == m_quote) ++i;
+                }
+            }
+
+        private:
+            friend class record;
+
+            field(string_view raw, char quote) : m_raw(raw), m_quote(quote) {}
+
+            string_view m_raw;
+            char m_quote;
+        };
+
+        // 一條記錄，按下標或迭代器訪問字段
+        class record
+        {
+        public:
+            class iterator
+            {
+            public:
+                typedef std::forward_iterator_tag iterator_category;
+                typedef field value_type;
+                typedef std::ptrdiff_t difference_type;
+                typedef const field* pointer;
+                typedef field reference;
+
+                iterator() : m_record(NULLPTR), m_index(0) {}
+                iterator(const record* r, size_type index) : m_record(r), m_index(index) {}
+
+                reference operator*() const { return (*m_record)[m_index]; }
+
+                iterator& operator++()
+                {
+                    ++m_index;
+                    return *this;
+                }
+
+                iterator operator++(int)
+                {
+                    iterator temp = *this;
+                    ++m_index;
+                    return temp;
+                }
+
+                bool operator==(const iterator& other) const { return m_index == other.m_index; }
+                bool operator!=(const iterator& other) const { return m_index != other.m_index; }
+
+            private:
+                const record* m_record;
+                size_type m_index;
+            };
+
+            record() : m_index(NULLPTR), m_first(0), m_size(0) {}
+
+            // 字段個數
+            size_type size() const
+            {
+                return m_size;
+            }
+
+            field operator[](size_type k) const
+            {
+                const size_type i = m_first + k;
+                const offset_type* sep = &m_index->m_separators[0];
+                size_type begin = i == 0 ? 0 : sep[i - 1] + 1;
+                size_type end = sep[i];
+                const char* data = m_index->m_input.data();
+
+                // CRLF換行的最後一個字段去掉\r
+                if (k + 1 == m_size && end > begin && end < m_index->m_input.size() && data[end - 1] == '\r')
+                {
+                    --end;
+                }
+                return field(string_view(data + begin, end - begin), m_index->m_quote);
+            }
+
+            field at(size_type k) const
+            {
+                if (k >= m_size) throw std::out_of_range("lite::structural_index::record::at");
+                return (*this)[k];
+            }
+
+            iterator begin() const
+            {
+                return iterator(this, 0);
+            }
+
+            iterator end() const
+            {
+                return iterator(this, m_size);
+            }
+
+            // 整條記錄的原始內容，不包括換行
+            string_view raw() const
+            {
+                if (m_size == 0) return string_view();
+                string_view first = (*this)[0].raw();
+                string_view last = (*this)[m_size - 1].raw();
+                return string_view(first.data(), last.data() + last.size() - first.data());
+            }
+
+        private:
+            friend class structural_index;
+
+            record(const structural_index* index, size_type first, size_type size)
+                : m_index(index), m_first(first), m_size(size)
+            {
+            }
+
+            const structural_index* m_index;
+            size_type m_first; // 第一個字段的結束分隔符在m_separators中的下標
+            size_type m_size;
+        };
+
+        // 記錄游標
+        class iterator
+        {
+        public:
+            typedef std::forward_iterator_tag iterator_category;
+            typedef record value_type;
+            typedef std::ptrdiff_t difference_type;
+            typedef const record* pointer;
+            typedef record reference;
+
+            iterator() : m_index(NULLPTR), m_row(0) {}
+            iterator(const structural_index* index, size_type row) : m_index(index), m_row(row) {}
+
+            reference operator*() const { return (*m_index)[m_row]; }
+
+            iterator& operator++()
+            {
+                ++m_row;
+                return *this;
+            }
+
+            iterator operator++(int)
+            {
+                iterator temp = *this;
+                ++m_row;
+                return temp;
+            }
+
+            bool operator==(const iterator& other) const { return m_row == other.m_row; }
+            bool operator!=(const iterator& other) const { return m_row != other.m_row; }
+
+        private:
+            const structural_index* m_index;
+            size_type m_row;
+        };
+
+        explicit structural_index(char delimiter = ',', char quote = '"')
+            : m_delimiter(delimiter), m_quote(quote), m_unterminated(false)
+        {
+        }
+
+        structural_index(string_view input, char delimiter = ',', char quote = '"')
+            : m_delimiter(delimiter), m_quote(quote), m_unterminated(false)
+        {
+            build(input);
+        }
+
+        // 重建索引，複用之前分配的內存
+        void build(string_view input)
+        {
+            if (input.size() >= size_type(offset_type(-1)))
+            {
+                throw std::length_error("lite::structural_index: input too large");
+            }
+
+            m_input = input;
+            m_separators.clear();
+            m_quotes.clear();
+            m_rows.assign(1, 0);
+            m_unterminated = false;
+
+            const char* p = input.data();
+            const size_type n = input.size();
+            unsigned long long inside = 0; // 上一塊結束時在引號內則全1
+            size_type i = 0;
+            for (; i + 64 <= n; i += 64)
+            {
+                _block(p + i, i, ~0ull, inside);
+            }
+            if (i < n)
+            {
+                char tail[64];
+                std::memcpy(tail, p + i, n - i);
+                std::memset(tail + (n - i), 0, 64 - (n - i));
+                _block(tail, i, (1ull << (n - i)) - 1, inside);
+            }
+            m_unterminated = inside != 0;
+
+            // 最後一條記錄沒有換行時補一個位於末尾的分隔符
+            if (n > 0 && (m_separators.empty() || m_separators.back() != n - 1 || p[n - 1] != '\n'))
+            {
+                m_separators.push_back(static_cast<offset_type>(n));
+                m_rows.push_back(static_cast<offset_type>(m_separators.size()));
+            }
+        }
+
+        string_view input() const
+        {
+            return m_input;
+        }
+
+        char delimiter() const
+        {
+            return m_delimiter;
+        }
+
+        char quote() const
+        {
+            return m_quote;
+        }
+
+        // 記錄條數
+        size_type size() const
+        {
+            return m_rows.size() - 1;
+        }
+
+        bool empty() const
+        {
+            return size() == 0;
+        }
+
+        // 輸入結束時仍在引號內
+        bool unterminated_quote() const
+        {
+            return m_unterminated;
+        }
+
+        record operator[](size_type r) const
+        {
+            return record(this, m_rows[r], m_rows[r + 1] - m_rows[r]);
+        }
+
+        record at(size_type r) const
+        {
+            if (r >= size()) throw std::out_of_range("lite::structural_index::at");
+            return (*this)[r];
+        }
+
+        iterator begin() const
+        {
+            return iterator(this, 0);
+        }
+
+        iterator end() const
+        {
+            return iterator(this, size());
+        }
+
+        // 引號外的分隔符和換行的偏移（升序，最後一條記錄沒有換行時末尾多一個輸入長度）
+        const std::vector<offset_type>& separators() const
+        {
+            return m_separators;
+        }
+
+        // 所有引號的偏移
+        const std::vector<offset_type>& quotes() const
+        {
+            return m_quotes;
+        }
+
+    private:
+        typedef unsigned long long mask_type;
+
+        // 64個字節中等於c的位掩碼
+        static mask_type _eq(const char* p, char c)
+        {
+#if defined(LITE_AVX2)
+            const __m256i v = _mm256_set1_epi8(c);
+            mask_type lo = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)), v)));
+            mask_type hi = static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + 32)), v)));
+            return lo | (hi << 32);
+#elif defined(LITE_SSE2)
+            const __m128i v = _mm_set1_epi8(c);
+            mask_type m = 0;
+            for (int k = 0; k < 4; ++k)
+            {
+                mask_type b = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + 16 * k)), v)));
+                m |= b << (16 * k);
+            }
+            return m;
+#else
+            mask_type m = 0;
+            for (int k = 0; k < 64; ++k)
+            {
+                if (p[k] == c) m |= 1ull << k;
+            }
+            return m;
+#endif
+        }
+
+        // 處理一塊64字節，valid是有效字節的掩碼，inside是跨塊的引號狀態
+        void _block(const char* p, size_type base, mask_type valid, mask_type& inside)
+        {
+            const mask_type quote = _eq(p, m_quote) & valid;
+            const mask_type newline = _eq(p, '\n') & valid;
+            const mask_type delimiter = _eq(p, m_delimiter) & valid;
+
+            const mask_type in = simd::prefix_xor(quote) ^ inside;
+            inside = static_cast<mask_type>(static_cast<long long>(in) >> 63);
+
+            for (mask_type q = quote; q != 0; q &= q - 1)
+            {
+                m_quotes.push_back(static_cast<offset_type>(base + simd::ctz64(q)));
+            }
+
+            const mask_type line = newline & ~in;
+            for (mask_type s = (delimiter | newline) & ~in; s != 0; s &= s - 1)
+            {
+                const unsigned bit = simd::ctz64(s);
+                m_separators.push_back(static_cast<offset_type>(base + bit));
+                if ((line >> bit) & 1u)
+                {
+                    m_rows.push_back(static_cast<offset_type>(m_separators.size()));
+                }
+            }
+        }
+
+        string_view m_input;
+        char m_delimiter;
+        char m_quote;
+        bool m_unterminated;
+        std::vector<offset_type> m_separators;
+        std::vector<offset_type> m_quotes;
+        std::vector<offset_type> m_rows; // 每條記錄第一個字段的結束分隔符在m_separators中的下標，末尾多一個
+    };
+}
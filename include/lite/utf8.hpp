@@ -0,0 +1,505 @@
+#pragma once
+#include <cstddef>  // std::size_t
+#include <cstring>  // std::memcpy
+#include <iterator> // std::forward_iterator_tag
+#include "macro.hpp"
+#include "simd.hpp"
+#include "string_view.hpp"
+
+namespace lite
+{
+    namespace utf8
+    {
+#if __cplusplus >= 201103L
+        typedef char32_t code_point;
+        typedef char16_t utf16_unit;
+#else
+        typedef unsigned int code_point;
+        typedef unsigned short utf16_unit;
+#endif
+
+        // 無效序列解碼爲U+FFFD
+        static const code_point replacement = 0xFFFD;
+
+        CONSTEXPR bool is_continuation(char c) NOEXCEPT
+        {
+            return (static_cast<unsigned char>(c) & 0xC0) == 0x80;
+        }
+
+        // 從p解碼一個碼位，n >= 1。返回序列長度，無效（截斷、過長編碼、代理、超過U+10FFFF）時返回0
+        inline std::size_t decode(const char* p, std::size_t n, code_point& cp)
+        {
+            const unsigned c = static_cast<unsigned char>(p[0]);
+            if (c < 0x80)
+            {
+                cp = c;
+                return 1;
+            }
+            if (c < 0xC2 || c > 0xF4) return 0;
+
+            const unsigned c1 = n > 1 ? static_cast<unsigned char>(p[1]) : 0;
+            if ((c1 & 0xC0) != 0x80) return 0;
+            if (c < 0xE0)
+            {
+                cp = ((c & 0x1F) << 6) | (c1 & 0x3F);
+                return 2;
+            }
+
+            // 第二字節的範圍取決於首字節：E0要A0以上，ED要9F以下，F0要90以上，F4要8F以下
+            if ((c == 0xE0 && c1 < 0xA0) || (c == 0xED && c1 > 0x9F) || (c == 0xF0 && c1 < 0x90) || (c == 0xF4 && c1 > 0x8F)) return 0;
+            if (n < 3 || !is_continuation(p[2])) return 0;
+            const unsigned c2 = static_cast<unsigned char>(p[2]);
+            if (c < 0xF0)
+            {
+                cp = ((c & 0x0F) << 12) | ((c1 & 0x3F) << 6) | (c2 & 0x3F);
+                return 3;
+            }
+
+            if (n < 4 || !is_continuation(p[3])) return 0;
+            cp = ((c & 0x07) << 18) | ((c1 & 0x3F) << 12) | ((c2 & 0x3F) << 6) | (static_cast<unsigned char>(p[3]) & 0x3F);
+            return 4;
+        }
+
+        // 最長的有效前綴的長度，即第一個無效字節的位置；全部有效時返回s.size()。
+        // 16字節（沒有SSE2時8字節）一組跳過ASCII，遇到多字節序列再逐個解碼
+        inline std::size_t valid_prefix(string_view s)
+        {
+            const char* p = s.data();
+            const std::size_t n = s.size();
+            std::size_t i = 0;
+            while (i < n)
+            {
+#if defined(LITE_SSE2)
+                if (i + 16 <= n && _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i))) == 0)
+                {
+                    i += 16;
+                    continue;
+                }
+#endif
+                if (i + 8 <= n && (simd::load64(reinterpret_cast<const unsigned char*>(p + i)) & 0x8080808080808080ull) == 0)
+                {
+                    i += 8;
+                    continue;
+                }
+                code_point cp;
+                const std::size_t len = decode(p + i, n - i, cp);
+                if (len == 0) return i;
+                i += len;
+            }
+            return n;
+        }
+
+#if defined(LITE_SSSE3)
+        // 查表法驗證（Keiser & Lemire, "Validating UTF-8 In Less Than One Instruction Per Byte"）。
+        // 每個字節和它前一個字節的高低半字節各查一張16項的表，三個結果相與，非零位就是一類錯誤；
+        // 第三、四字節位置是否必須是後續字節另由前兩、三個字節是否是三、四字節首字節判斷。
+        // Block封裝16/32字節的向量操作，32字節時每128位一組查表
+        namespace detail
+        {
+            enum
+            {
+                too_short = 1 << 0,  // 11______ 0_______ 或 11______ 11______
+                too_long = 1 << 1,   // 0_______ 10______
+                overlong_3 = 1 << 2, // 11100000 100_____
+                too_large = 1 << 3,  // 11110100 1001____，11110100 101_____，11110101以上
+                surrogate = 1 << 4,  // 11101101 101_____
+                overlong_2 = 1 << 5, // 1100000_ 10______
+                too_large_1000 = 1 << 6, // 11110101以上 1000____
+                overlong_4 = 1 << 6,     // 11110000 1000____
+                two_conts = 1 << 7,      // 10______ 10______，三、四字節序列中這是正確的，由must23抵消
+                carry = too_short | too_long | two_conts
+            };
+
+            // 前一個字節的高半字節
+            static const unsigned char byte_1_high[16] = {
+                too_long, too_long, too_long, too_long, too_long, too_long, too_long, too_long,
+                two_conts, two_conts, two_conts, two_conts,
+                too_short | overlong_2,
+                too_short,
+                too_short | overlong_3 | surrogate,
+                too_short | too_large | too_large_1000 | overlong_4
+            };
+
+            // 前一個字節的低半字節
+            static const unsigned char byte_1_low[16] = {
+                carry | overlong_3 | overlong_2 | overlong_4,
+                carry | overlong_2,
+                carry,
+                carry,
+                carry | too_large,
+                carry | too_large | too_large_1000,
+                carry | too_large | too_large_1000,
+                carry | too_large | too_large_1000,
+                carry | too_large | too_large_1000,
+                carry | too_large | too_large_1000,
+                carry | too_large | too_large_1000,
+                carry | too_large | too_large_1000,
+                carry | too_large | too_large_1000,
+                carry | too_large | too_large_1000 | surrogate,
+                carry | too_large | too_large_1000,
+                carry | too_large | too_large_1000
+            };
+
+            // 當前字節的高半字節
+            static const unsigned char byte_2_high[16] = {
+                too_short, too_short, too_short, too_short, too_short, too_short, too_short, too_short,
+                too_long | overlong_2 | two_conts | overlong_3 | too_large_1000 | overlong_4,
+                too_long | overlong_2 | two_conts | overlong_3 | too_large,
+                too_long | overlong_2 | two_conts | surrogate | too_large,
+                too_long | overlong_2 | two_conts | surrogate | too_large,
+                too_short, too_short, too_short, too_short
+            };
+
+            struct sse_block
+            {
+                typedef __m128i type;
+                enum { size = 16 };
+
+                static type load(const char* p) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+                static type table(const unsigned char* t) { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(t)); }
+                static type set1(int c) { return _mm_set1_epi8(static_cast<char>(c)); }
+                static type zero() { return _mm_setzero_si128(); }
+                static type lookup(type t, type i) { return _mm_shuffle_epi8(t, i); }
+                static type high(type x) { return _mm_and_si128(_mm_srli_epi16(x, 4), set1(0x0F)); }
+                static type low(type x) { return _mm_and_si128(x, set1(0x0F)); }
+                static type and_(type a, type b) { return _mm_and_si128(a, b); }
+                static type or_(type a, type b) { return _mm_or_si128(a, b); }
+                static type xor_(type a, type b) { return _mm_xor_si128(a, b); }
+                static type subs(type a, type b) { return _mm_subs_epu8(a, b); }
+                static bool is_ascii(type x) { return _mm_movemask_epi8(x) == 0; }
+                static bool any(type x) { return _mm_movemask_epi8(_mm_cmpeq_epi8(x, zero())) != 0xFFFF; }
+
+                // 前一塊的最後N個字節接上當前塊的前16 - N個字節
+                template <int N>
+                static type prev(type x, type last) { return _mm_alignr_epi8(x, last, 16 - N); }
+            };
+
+#  if defined(LITE_AVX2)
+            struct avx_block
+            {
+                typedef __m256i type;
+                enum { size = 32 };
+
+                static type load(const char* p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+                static type table(const unsigned char* t) { return _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(t))); }
+                static type set1(int c) { return _mm256_set1_epi8(static_cast<char>(c)); }
+                static type zero() { return _mm256_setzero_si256(); }
+                static type lookup(type t, type i) { return _mm256_shuffle_epi8(t, i); }
+                static type high(type x) { return _mm256_and_si256(_mm256_srli_epi16(x, 4), set1(0x0F)); }
+                static type low(type x) { return _mm256_and_si256(x, set1(0x0F)); }
+                static type and_(type a, type b) { return _mm256_and_si256(a, b); }
+                static type or_(type a, type b) { return _mm256_or_si256(a, b); }
+                static type xor_(type a, type b) { return _mm256_xor_si256(a, b); }
+                static type subs(type a, type b) { return _mm256_subs_epu8(a, b); }
+                static bool is_ascii(type x) { return _mm256_movemask_epi8(x) == 0; }
+                static bool any(type x) { return !_mm256_testz_si256(x, x); }
+
+                // alignr按128位分組，先拼出[last高128位, x低128位]
+                template <int N>
+                static type prev(type x, type last) { return _mm256_alignr_epi8(x, _mm256_permute2x128_si256(last, x, 0x21), 16 - N); }
+            };
+#  endif
+
+            template <typename Block>
+            struct checker
+            {
+                typedef typename Block::type type;
+
+                checker()
+                    : m_error(Block::zero()), m_prev(Block::zero()), m_incomplete(Block::zero()),
+                      m_byte_1_high(Block::table(byte_1_high)), m_byte_1_low(Block::table(byte_1_low)),
+                      m_byte_2_high(Block::table(byte_2_high))
+                {
+                    // 塊的最後三個字節分別不能是四字節、三字節以上、二字節以上序列的首字節
+                    unsigned char tail[Block::size];
+                    std::memset(tail, 0xFF, sizeof(tail));
+                    tail[Block::size - 3] = 0xF0 - 1;
+                    tail[Block::size - 2] = 0xE0 - 1;
+                    tail[Block::size - 1] = 0xC0 - 1;
+                    std::memcpy(&m_tail, tail, sizeof(tail));
+                }
+
+                // 全是ASCII的塊只需要確認前一塊沒有截斷的序列。
+                // 這時m_prev不更新：前一塊完整結束時，它的末尾字節和ASCII對後面的判斷結果相同
+                void step(type input)
+                {
+                    if (Block::is_ascii(input))
+                    {
+                        m_error = Block::or_(m_error, m_incomplete);
+                        return;
+                    }
+
+                    const type prev1 = Block::template prev<1>(input, m_prev);
+                    const type special = Block::and_(Block::and_(Block::lookup(m_byte_1_high, Block::high(prev1)),
+                                                                 Block::lookup(m_byte_1_low, Block::low(prev1))),
+                                                     Block::lookup(m_byte_2_high, Block::high(input)));
+
+                    // 前兩個字節是111_____或前三個字節是1111____時，這裏必須是後續字節
+                    const type third = Block::subs(Block::template prev<2>(input, m_prev), Block::set1(0xE0 - 0x80));
+                    const type fourth = Block::subs(Block::template prev<3>(input, m_prev), Block::set1(0xF0 - 0x80));
+                    const type must23 = Block::and_(Block::or_(third, fourth), Block::set1(0x80));
+
+                    m_error = Block::or_(m_error, Block::xor_(must23, special));
+                    m_incomplete = Block::subs(input, m_tail);
+                    m_prev = input;
+                }
+
+                bool valid()
+                {
+                    return !Block::any(Block::or_(m_error, m_incomplete));
+                }
+
+                type m_error;
+                type m_prev;
+                type m_incomplete; // 前一塊末尾有沒有結束的序列
+                type m_tail;
+                type m_byte_1_high;
+                type m_byte_1_low;
+                type m_byte_2_high;
+            };
+
+            template <typename Block>
+            inline bool validate_blocks(const char* p, std::size_t n)
+            {
+                checker<Block> c;
+                std::size_t i = 0;
+                for (; i + Block::size <= n; i += Block::size)
+                {
+                    c.step(Block::load(p + i));
+                }
+                if (i < n)
+                {
+                    // 尾部補0：0是ASCII，截斷的序列會被當作too_short
+                    char last[Block::size] = {};
+                    std::memcpy(last, p + i, n - i);
+                    c.step(Block::load(last));
+                }
+                return c.valid();
+            }
+        }
+#endif
+
+        // s是否是有效的UTF-8
+        inline bool validate(string_view s)
+        {
+#if defined(LITE_AVX2)
+            return detail::validate_blocks<detail::avx_block>(s.data(), s.size());
+#elif defined(LITE_SSSE3)
+            return detail::validate_blocks<detail::sse_block>(s.data(), s.size());
+#else
+            return valid_prefix(s) == s.size();
+#endif
+        }
+
+        // 碼位數：不是後續字節的字節數。只對有效的UTF-8有意義，否則每個無效的首字節也算一個。
+        // 有符號比較：後續字節0x80-0xBF是-128到-65。比較結果（-1）按字節累加，最多255次後用sad求和
+        inline std::size_t count(string_view s)
+        {
+            const char* p = s.data();
+            const std::size_t n = s.size();
+            std::size_t i = 0;
+            std::size_t result = 0;
+#if defined(LITE_AVX2)
+            while (i + 32 <= n)
+            {
+                __m256i sum = _mm256_setzero_si256();
+                for (int k = 0; k < 255 && i + 32 <= n; ++k, i += 32)
+                {
+                    __m256i x = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+                    sum = _mm256_sub_epi8(sum, _mm256_cmpgt_epi8(x, _mm256_set1_epi8(-65)));
+                }
+                sum = _mm256_sad_epu8(sum, _mm256_setzero_si256());
+                __m128i half = _mm_add_epi64(_mm256_castsi256_si128(sum), _mm256_extracti128_si256(sum, 1));
+                result += static_cast<std::size_t>(_mm_cvtsi128_si32(half) + _mm_extract_epi16(half, 4));
+            }
+#endif
+#if defined(LITE_SSE2)
+            while (i + 16 <= n)
+            {
+                __m128i sum = _mm_setzero_si128();
+                for (int k = 0; k < 255 && i + 16 <= n; ++k, i += 16)
+                {
+                    __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+                    sum = _mm_sub_epi8(sum, _mm_cmpgt_epi8(x, _mm_set1_epi8(-65)));
+                }
+                sum = _mm_sad_epu8(sum, _mm_setzero_si128());
+                result += static_cast<std::size_t>(_mm_cvtsi128_si32(sum) + _mm_extract_epi16(sum, 4));
+            }
+#endif
+            for (; i < n; ++i)
+            {
+                result += !is_continuation(p[i]);
+            }
+            return result;
+        }
+
+        // 不超過max_bytes字節且不切斷碼位的前綴。
+        // 最多回退3個後續字節，無效的UTF-8也不會退到很遠
+        inline string_view truncate(string_view s, std::size_t max_bytes)
+        {
+            if (s.size() <= max_bytes) return s;
+
+            std::size_t i = max_bytes;
+            for (int k = 0; k < 3 && i > 0 && is_continuation(s[i]); ++k)
+            {
+                --i;
+            }
+            if (is_continuation(s[i])) i = max_bytes; // 不是合法的序列，按字節截斷
+            return s.substr(0, i);
+        }
+
+        // 轉爲UTF-16寫入dst，返回寫入的部分。dst至少要有s.size()個單元（每個字節最多產生一個單元）。
+        // 無效序列寫入U+FFFD並跳過一個字節，需要報錯時先validate。
+        // 16個ASCII字節一組直接擴展爲16位，其餘逐個解碼
+        inline basic_string_view<utf16_unit> to_utf16(string_view s, utf16_unit* dst)
+        {
+            const char* p = s.data();
+            const std::size_t n = s.size();
+            std::size_t i = 0;
+            utf16_unit* out = dst;
+            while (i < n)
+            {
+#if defined(LITE_SSE2)
+                if (i + 16 <= n)
+                {
+                    __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+                    if (_mm_movemask_epi8(x) == 0)
+                    {
+                        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), _mm_unpacklo_epi8(x, _mm_setzero_si128()));
+                        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + 8), _mm_unpackhi_epi8(x, _mm_setzero_si128()));
+                        i += 16;
+                        out += 16;
+                        continue;
+                    }
+                }
+#endif
+                code_point cp = replacement;
+                std::size_t len = decode(p + i, n - i, cp);
+                if (len == 0)
+                {
+                    cp = replacement;
+                    len = 1;
+                }
+                i += len;
+                if (cp < 0x10000)
+                {
+                    *out++ = static_cast<utf16_unit>(cp);
+                }
+                else
+                {
+                    cp -= 0x10000;
+                    *out++ = static_cast<utf16_unit>(0xD800 + (cp >> 10));
+                    *out++ = static_cast<utf16_unit>(0xDC00 + (cp & 0x3FF));
+                }
+            }
+            return basic_string_view<utf16_unit>(dst, out - dst);
+        }
+
+        // 逐碼位遍歷，解引用得到碼位，無效序列得到U+FFFD並前進一個字節
+        class code_point_iterator
+        {
+        public:
+            typedef std::forward_iterator_tag iterator_category;
+            typedef code_point value_type;
+            typedef std::ptrdiff_t difference_type;
+            typedef const code_point* pointer;
+            typedef code_point reference;
+
+            code_point_iterator() : m_pos(NULLPTR), m_end(NULLPTR), m_size(0), m_value(0) {}
+
+            code_point_iterator(const char* pos, const char* end) : m_pos(pos), m_end(end), m_size(0), m_value(0)
+            {
+                _decode();
+            }
+
+            code_point operator*() const
+            {
+                return m_value;
+            }
+
+            // 當前碼位在原串中的位置和字節數
+            const char* base() const
+            {
+                return m_pos;
+            }
+
+            std::size_t size() const
+            {
+                return m_size;
+            }
+
+            code_point_iterator& operator++()
+            {
+                m_pos += m_size;
+                _decode();
+                return *this;
+            }
+
+            code_point_iterator operator++(int)
+            {
+                code_point_iterator old = *this;
+                ++*this;
+                return old;
+            }
+
+            friend bool operator==(const code_point_iterator& a, const code_point_iterator& b)
+            {
+                return a.m_pos == b.m_pos;
+            }
+
+            friend bool operator!=(const code_point_iterator& a, const code_point_iterator& b)
+            {
+                return a.m_pos != b.m_pos;
+            }
+
+        private:
+            void _decode()
+            {
+                if (m_pos == m_end)
+                {
+                    m_size = 0;
+                    return;
+                }
+                m_size = decode(m_pos, m_end - m_pos, m_value);
+                if (m_size == 0)
+                {
+                    m_value = replacement;
+                    m_size = 1;
+                }
+            }
+
+            const char* m_pos;
+            const char* m_end;
+            std::size_t m_size;
+            code_point m_value;
+        };
+
+        // for (lite::utf8::code_point c : lite::utf8::code_points(s))
+        class code_point_range
+        {
+        public:
+            typedef code_point_iterator iterator;
+            typedef code_point_iterator const_iterator;
+
+            explicit code_point_range(string_view s) : m_view(s) {}
+
+            iterator begin() const
+            {
+                return iterator(m_view.data(), m_view.data() + m_view.size());
+            }
+
+            iterator end() const
+            {
+                return iterator(m_view.data() + m_view.size(), m_view.data() + m_view.size());
+            }
+
+        private:
+            string_view m_view;
+        };
+
+        inline code_point_range code_points(string_view s)
+        {
+            return code_point_range(s);
+        }
+    }
+}
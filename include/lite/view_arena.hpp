@@ -0,0 +1,267 @@
+#pragma once
+#include <cstddef>  // std::size_t
+#include <cstring>  // std::memcpy
+#include <iterator> // std::iterator_traits
+#include <string>   // std::basic_string
+#include <vector>   // std::vector
+#include "macro.hpp"
+#include "string_view.hpp"
+
+namespace lite
+{
+    // 視圖的存儲區：把字符串複製進大塊內存（slab），返回指向副本的視圖。
+    // 副本在reset()或析構之前一直有效，每個字符串不再單獨分配內存。
+    // 比slab一半還大的字符串單獨分配一塊，不浪費當前slab的剩餘空間。
+    // 不能複製；不是線程安全的。
+    class view_arena
+    {
+    public:
+        typedef std::size_t size_type;
+
+        struct statistics
+        {
+            size_type slabs;    // 持有的內存塊數
+            size_type reserved; // 持有的總字節數
+            size_type used;     // 存入的字節數
+            size_type padding;  // 對齊浪費的字節數
+            size_type wasted;   // 換塊時丟棄的塊尾字節數
+            size_type stored;   // 存入的字符串個數
+        };
+
+        static const size_type default_slab_size = 64 * 1024;
+
+        // alignment是每個副本起點的對齊，必須是2的冪；實際對齊不小於sizeof(CharT)
+        explicit view_arena(size_type slab_size = default_slab_size, size_type alignment = 1)
+            : m_slab_size(slab_size == 0 ? size_type(default_slab_size) : slab_size),
+              m_alignment(alignment == 0 ? 1 : alignment),
+              m_current(0), m_pos(NULLPTR), m_end(NULLPTR)
+        {
+            _clear_stats();
+        }
+
+        ~view_arena()
+        {
+            release();
+        }
+
+        // 複製v的字符，返回指向副本的視圖。空視圖不佔空間
+        template <typename CharT, typename Traits>
+        basic_string_view<CharT, Traits> store(basic_string_view<CharT, Traits> v)
+        {
+            if (v.empty()) return basic_string_view<CharT, Traits>();
+
+            const size_type bytes = v.size() * sizeof(CharT);
+            void* p = allocate(bytes, sizeof(CharT) > m_alignment ? sizeof(CharT) : m_alignment);
+            std::memcpy(p, v.data(), bytes);
+            ++m_stats.stored;
+            return basic_string_view<CharT, Traits>(static_cast<const CharT*>(p), v.size());
+        }
+
+        template <typename CharT, typename Traits, typename Alloc>
+        basic_string_view<CharT, Traits> store(const std::basic_string<CharT, Traits, Alloc>& s)
+        {
+            return store(basic_string_view<CharT, Traits>(s.data(), s.size()));
+        }
+
+        string_view store(const char* s)
+        {
+            return store(string_view(s));
+        }
+
+        // 依次存入[first, last)的每個視圖，把得到的視圖寫到out，返回寫完後的out。
+        // 前向迭代器先統計總長度，一次準備好足夠的空間
+        template <typename InputIt, typename OutputIt>
+        OutputIt store_many(InputIt first, InputIt last, OutputIt out)
+        {
+            typedef typename std::iterator_traits<InputIt>::iterator_category category;
+            _reserve_for(first, last, category());
+            for (; first != last; ++first)
+            {
+                *out = store(*first);
+                ++out;
+            }
+            return out;
+        }
+
+        // 分配bytes字節、按align對齊（2的冪）的內存
+        void* allocate(size_type bytes, size_type align)
+        {
+            char* p = _align(m_pos, align);
+            if (m_pos == NULLPTR || bytes > static_cast<size_type>(m_end - p))
+            {
+                if (bytes + align > m_slab_size / 2) return _allocate_large(bytes, align);
+
+                _next_slab();
+                p = _align(m_pos, align);
+            }
+            m_stats.padding += p - m_pos;
+            m_stats.used += bytes;
+            m_pos = p + bytes;
+            return p;
+        }
+
+        // 讓之前返回的所有視圖失效，保留普通大小的塊供之後使用，釋放單獨分配的大塊
+        void reset()
+        {
+            for (size_type i = 0; i < m_large.size(); ++i)
+            {
+                delete[] m_large[i];
+            }
+            m_large.clear();
+            m_current = 0;
+            if (m_slabs.empty())
+            {
+                m_pos = m_end = NULLPTR;
+            }
+            else
+            {
+                m_pos = m_slabs[0];
+                m_end = m_pos + m_slab_size;
+            }
+            _clear_stats();
+        }
+
+        // 釋放所有內存
+        void release()
+        {
+            reset();
+            for (size_type i = 0; i < m_slabs.size(); ++i)
+            {
+                delete[] m_slabs[i];
+            }
+            m_slabs.clear();
+            m_pos = m_end = NULLPTR;
+        }
+
+        size_type slab_size() const
+        {
+            return m_slab_size;
+        }
+
+        size_type alignment() const
+        {
+            return m_alignment;
+        }
+
+        // 存入的字節數
+        size_type bytes_used() const
+        {
+            return m_stats.used;
+        }
+
+        // 持有的總字節數，包括reset後留着複用的塊
+        size_type bytes_reserved() const
+        {
+            return m_slabs.size() * m_slab_size + m_large_bytes;
+        }
+
+        statistics stats() const
+        {
+            statistics s = m_stats;
+            s.slabs = m_slabs.size() + m_large.size();
+            s.reserved = bytes_reserved();
+            return s;
+        }
+
+    private:
+        view_arena(const view_arena&);
+        view_arena& operator=(const view_arena&);
+
+        static char* _align(char* p, size_type align)
+        {
+            std::size_t a = reinterpret_cast<std::size_t>(p);
+            return p + ((align - (a & (align - 1))) & (align - 1));
+        }
+
+        void _clear_stats()
+        {
+            m_stats.slabs = 0;
+            m_stats.reserved = 0;
+            m_stats.used = 0;
+            m_stats.padding = 0;
+            m_stats.wasted = 0;
+            m_stats.stored = 0;
+            m_large_bytes = 0;
+        }
+
+        // 先按倍增騰出位置，之後的push_back不會拋出，剛分配的塊不會因此泄漏
+        static void _make_room(std::vector<char*>& blocks)
+        {
+            if (blocks.size() == blocks.capacity()) blocks.reserve(blocks.size() * 2 + 1);
+        }
+
+        // 換到下一塊，需要時新分配。分配失敗時狀態不變
+        void _next_slab()
+        {
+            size_type next = m_pos != NULLPTR ? m_current + 1 : m_current;
+            if (next >= m_slabs.size())
+            {
+                _make_room(m_slabs);
+                m_slabs.push_back(new char[m_slab_size]);
+                next = m_slabs.size() - 1;
+            }
+            if (m_pos != NULLPTR) m_stats.wasted += m_end - m_pos;
+            m_current = next;
+            m_pos = m_slabs[m_current];
+            m_end = m_pos + m_slab_size;
+        }
+
+        void* _allocate_large(size_type bytes, size_type align)
+        {
+            _make_room(m_large);
+            char* block = new char[bytes + align];
+            m_large.push_back(block);
+            m_large_bytes += bytes + align;
+            char* p = _align(block, align);
+            m_stats.padding += p - block;
+            m_stats.used += bytes;
+            return p;
+        }
+
+        template <typename InputIt>
+        void _reserve_for(InputIt, InputIt, std::input_iterator_tag)
+        {
+        }
+
+        template <typename ForwardIt>
+        void _reserve_for(ForwardIt first, ForwardIt last, std::forward_iterator_tag)
+        {
+            size_type total = 0;
+            for (; first != last; ++first)
+            {
+                total += _bytes(*first) + m_alignment;
+            }
+            if (total <= m_slab_size / 2 && m_pos != NULLPTR && total > static_cast<size_type>(m_end - m_pos))
+            {
+                _next_slab();
+            }
+        }
+
+        template <typename CharT, typename Traits>
+        static size_type _bytes(basic_string_view<CharT, Traits> v)
+        {
+            return v.size() * sizeof(CharT);
+        }
+
+        template <typename CharT, typename Traits, typename Alloc>
+        static size_type _bytes(const std::basic_string<CharT, Traits, Alloc>& s)
+        {
+            return s.size() * sizeof(CharT);
+        }
+
+        static size_type _bytes(const char* s)
+        {
+            return std::char_traits<char>::length(s);
+        }
+
+        size_type m_slab_size;
+        size_type m_alignment;
+        std::vector<char*> m_slabs;
+        std::vector<char*> m_large;
+        size_type m_large_bytes;
+        size_type m_current; // 正在使用的塊
+        char* m_pos;
+        char* m_end;
+        statistics m_stats;
+    };
+}
@@ -0,0 +1,373 @@
+#pragma once
+#include <lite/string_view.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// lite::basic_string_view與std::basic_string_view逐個成員對比的性能測試。
+// 每個測量用同一份數據分別調用兩種實現，結果按名稱（成員/字符類型/模式/模式串長度/字節數）區分，
+// 可以輸出爲文本表格或JSON（每個結果一行），string_view_perfcheck用同樣的格式保存和讀取基線。
+namespace bench
+{
+    struct options
+    {
+        double min_time = 0.01;              // 每個測量至少運行的秒數
+        std::size_t min_bytes = 16;          // 數據大小從min_bytes按16倍增長，最後一個是max_bytes
+        std::size_t max_bytes = std::size_t(64) << 20;
+        std::string filter;                  // 只運行名稱包含filter的測量
+        std::vector<std::size_t> sizes;      // 非空時只用這些大小，忽略min_bytes和max_bytes
+        std::size_t repetitions = 1;         // 每個測量重複的次數，結果取中位數
+        bool warmup = false;                 // 正式計時之前先空跑一輪
+        bool with_std = true;                // 爲false時只測lite
+    };
+
+    struct result
+    {
+        std::string name;      // member/char/pattern/needle/bytes，兩次運行之間用它對應
+        std::string member;    // 成員函數
+        std::string impl;      // lite或std
+        std::string char_type;
+        std::string pattern;   // hit：目標在掃描的最遠處；miss：沒有目標；dense：到處是部分匹配
+        std::size_t bytes;     // 被掃描的數據的字節數
+        std::size_t needle;    // 模式串或字符集合的長度，沒有時爲0
+        double ns;             // 每次調用的納秒數，重複多次時是中位數
+        double mad;            // 各次重複的ns與中位數之差的絕對值的中位數
+        double gbps;           // bytes / ns
+        std::vector<double> samples;
+    };
+
+    inline volatile std::size_t sink = 0;
+
+    // 每次調用的納秒數：批次大小按上一批的耗時估算，直到一批運行了min_time秒
+    template <typename F>
+    double time_ns(F&& f, double min_time)
+    {
+        typedef std::chrono::steady_clock clock;
+        std::size_t iterations = 1;
+        for (;;)
+        {
+            clock::time_point start = clock::now();
+            for (std::size_t i = 0; i < iterations; ++i)
+            {
+                sink = sink + static_cast<std::size_t>(f());
+            }
+            double seconds = std::chrono::duration<double>(clock::now() - start).count();
+            if (seconds >= min_time) return seconds * 1e9 / static_cast<double>(iterations);
+
+            double scale = seconds > 0 ? min_time / seconds * 1.2 : 100.0;
+            iterations = static_cast<std::size_t>(static_cast<double>(iterations) * std::min(std::max(scale, 2.0), 100.0));
+        }
+    }
+
+    // samples會被重排
+    inline double median(std::vector<double>& samples)
+    {
+        const std::size_t n = samples.size();
+        std::sort(samples.begin(), samples.end());
+        return n % 2 ? samples[n / 2] : (samples[n / 2 - 1] + samples[n / 2]) / 2;
+    }
+
+    inline double median_absolute_deviation(const std::vector<double>& samples, double center)
+    {
+        std::vector<double> d(samples.size());
+        for (std::size_t i = 0; i < samples.size(); ++i) d[i] = samples[i] < center ? center - samples[i] : samples[i] - center;
+        return median(d);
+    }
+
+    // 由samples算出ns、mad和gbps
+    inline void summarize(result& r)
+    {
+        if (r.samples.empty())
+        {
+            r.ns = r.mad = r.gbps = 0;
+            return;
+        }
+        std::vector<double> sorted(r.samples);
+        r.ns = median(sorted);
+        r.mad = median_absolute_deviation(r.samples, r.ns);
+        r.gbps = static_cast<double>(r.bytes) / r.ns;
+    }
+
+    template <typename CharT> const char* char_name();
+    template <> inline const char* char_name<char>() { return "char"; }
+    template <> inline const char* char_name<char16_t>() { return "char16_t"; }
+    template <> inline const char* char_name<char32_t>() { return "char32_t"; }
+    template <> inline const char* char_name<wchar_t>() { return "wchar_t"; }
+
+    class suite
+    {
+    public:
+        // 每得到一對（lite、std）結果調用一次report
+        typedef void (*reporter)(const result& lite, const result& std, void* context);
+
+        suite(const options& o, reporter report, void* context)
+            : m_options(o), m_report(report), m_context(context)
+        {
+        }
+
+        const std::vector<result>& results() const
+        {
+            return m_results;
+        }
+
+        void run()
+        {
+            std::vector<std::size_t> sizes(m_options.sizes);
+            if (sizes.empty())
+            {
+                for (std::size_t bytes = m_options.min_bytes; bytes < m_options.max_bytes; bytes *= 16) sizes.push_back(bytes);
+                sizes.push_back(m_options.max_bytes);
+            }
+
+            for (std::size_t bytes : sizes)
+            {
+                run_size<char>(bytes);
+                run_size<char16_t>(bytes);
+                run_size<char32_t>(bytes);
+                run_size<wchar_t>(bytes);
+            }
+        }
+
+    private:
+        // 文本由'a'到'p'十六個字母隨機組成，'z'和','不會出現，用作查找目標
+        template <typename CharT>
+        static void fill(std::vector<CharT>& text)
+        {
+            unsigned long long x = 88172645463325252ull;
+            for (std::size_t i = 0; i < text.size(); ++i)
+            {
+                x ^= x << 13;
+                x ^= x >> 7;
+                x ^= x << 17;
+                text[i] = static_cast<CharT>('a' + (x >> 60));
+            }
+        }
+
+        template <typename CharT>
+        void run_size(std::size_t bytes)
+        {
+            typedef lite::basic_string_view<CharT> lite_view;
+            typedef std::basic_string_view<CharT> std_view;
+
+            const std::size_t n = bytes / sizeof(CharT);
+            if (n < 2) return;
+
+            std::vector<CharT> text(n);
+            fill(text);
+            std::vector<CharT> other;
+            std::vector<CharT> out(n);
+
+            const CharT target = CharT('z');
+            const CharT set[] = { CharT('x'), CharT('y'), CharT('z'), CharT(',') };
+            CharT alphabet[16];
+            for (int i = 0; i < 16; ++i) alphabet[i] = static_cast<CharT>('a' + i);
+
+            // 單字符和字符集合：hit時目標放在掃描的最後一個位置
+            for (int hit = 1; hit >= 0; --hit)
+            {
+                const char* pattern = hit ? "hit" : "miss";
+                if (hit) text[n - 1] = target;
+                measure<CharT>("find(char)", pattern, bytes, 1, [&](auto v) { return v.find(target); }, text);
+                measure<CharT>("find_first_of", pattern, bytes, 4, [&](auto v) { return v.find_first_of(decltype(v)(set, 4)); }, text);
+                measure<CharT>("find_first_not_of", pattern, bytes, 16, [&](auto v) { return v.find_first_not_of(decltype(v)(alphabet, 16)); }, text);
+                if (hit)
+                {
+                    text[n - 1] = alphabet[0];
+                    text[0] = target;
+                }
+                measure<CharT>("rfind(char)", pattern, bytes, 1, [&](auto v) { return v.rfind(target); }, text);
+                measure<CharT>("find_last_of", pattern, bytes, 4, [&](auto v) { return v.find_last_of(decltype(v)(set, 4)); }, text);
+                measure<CharT>("find_last_not_of", pattern, bytes, 16, [&](auto v) { return v.find_last_not_of(decltype(v)(alphabet, 16)); }, text);
+                text[0] = alphabet[0];
+            }
+
+            // 子串：模式串由文本中的字母組成，最後一個字符是'z'。
+            // hit時複製到掃描的最遠處；dense時文本全是'a'，模式串是若干'a'加'z'，每個位置都部分匹配
+            const std::size_t needles[] = { 2, 8, 32, 256 };
+            for (std::size_t m : needles)
+            {
+                if (m >= n) continue;
+                std::vector<CharT> needle(text.begin() + n / 2, text.begin() + n / 2 + m);
+                needle[m - 1] = target;
+
+                const char* patterns[] = { "hit", "miss", "dense" };
+                for (const char* pattern : patterns)
+                {
+                    std::vector<CharT> h(text);
+                    std::vector<CharT> s(needle);
+                    if (std::strcmp(pattern, "dense") == 0)
+                    {
+                        std::fill(h.begin(), h.end(), alphabet[0]);
+                        std::fill(s.begin(), s.end() - 1, alphabet[0]);
+                    }
+                    if (std::strcmp(pattern, "miss") != 0) std::copy(s.begin(), s.end(), h.end() - m);
+                    measure<CharT>("find", pattern, bytes, m, [&](auto v) { return v.find(decltype(v)(s.data(), m)); }, h);
+
+                    if (std::strcmp(pattern, "miss") != 0)
+                    {
+                        std::copy(h.end() - m, h.end(), h.begin()); // rfind的最遠處在開頭，h[m - 1]是'z'
+                        if (std::strcmp(pattern, "dense") == 0) std::fill(h.begin() + m, h.end(), alphabet[0]);
+                        else std::copy(text.end() - m, text.end(), h.end() - m);
+                    }
+                    measure<CharT>("rfind", pattern, bytes, m, [&](auto v) { return v.rfind(decltype(v)(s.data(), m)); }, h);
+                }
+            }
+
+            // 比較：equal時內容相同，hit時只有最後一個字符不同
+            other = text;
+            for (int differ = 0; differ <= 1; ++differ)
+            {
+                const char* pattern = differ ? "hit" : "equal";
+                other[n - 1] = differ ? target : text[n - 1];
+                const lite_view lo(other.data(), n);
+                const std_view so(other.data(), n);
+                measure2<CharT>("compare", pattern, bytes, n,
+                                [&](lite_view v) { return static_cast<std::size_t>(v.compare(lo) + 1); },
+                                [&](std_view v) { return static_cast<std::size_t>(v.compare(so) + 1); }, text);
+                measure2<CharT>("operator==", pattern, bytes, n,
+                                [&](lite_view v) { return static_cast<std::size_t>(v == lo); },
+                                [&](std_view v) { return static_cast<std::size_t>(v == so); }, text);
+                measure2<CharT>("starts_with", pattern, bytes, n,
+                                [&](lite_view v) { return static_cast<std::size_t>(v.starts_with(lo)); },
+                                [&](std_view v) { return static_cast<std::size_t>(v.starts_with(so)); }, text);
+                measure2<CharT>("ends_with", pattern, bytes, n,
+                                [&](lite_view v) { return static_cast<std::size_t>(v.ends_with(lo)); },
+                                [&](std_view v) { return static_cast<std::size_t>(v.ends_with(so)); }, text);
+            }
+
+            measure<CharT>("copy", "all", bytes, 0, [&](auto v) { return v.copy(out.data(), n); }, text);
+            measure<CharT>("substr", "all", bytes, 0, [&](auto v) { return v.substr(n / 2).size(); }, text);
+        }
+
+        // 同一個泛型lambda分別用於兩種視圖
+        template <typename CharT, typename F>
+        void measure(const char* member, const char* pattern, std::size_t bytes, std::size_t needle, F f, const std::vector<CharT>& text)
+        {
+            measure2<CharT>(member, pattern, bytes, needle, f, f, text);
+        }
+
+        template <typename CharT, typename L, typename S>
+        void measure2(const char* member, const char* pattern, std::size_t bytes, std::size_t needle, L lite_f, S std_f,
+                      const std::vector<CharT>& text)
+        {
+            char name[160];
+            std::snprintf(name, sizeof(name), "%s/%s/%s/%zu/%zu", member, char_name<CharT>(), pattern, needle, bytes);
+            if (!m_options.filter.empty() && std::strstr(name, m_options.filter.c_str()) == NULLPTR) return;
+
+            const lite::basic_string_view<CharT> lv(text.data(), text.size());
+            const std::basic_string_view<CharT> sv(text.data(), text.size());
+            const std::size_t count = m_options.with_std ? 2 : 1;
+            result r[2];
+            r[0].impl = "lite";
+            r[1].impl = "std";
+            if (m_options.warmup)
+            {
+                time_ns([&] { return lite_f(lv); }, m_options.min_time);
+                if (count == 2) time_ns([&] { return std_f(sv); }, m_options.min_time);
+            }
+            // 兩種實現交替運行，頻率等的漂移對兩邊影響相同
+            for (std::size_t i = 0; i < m_options.repetitions; ++i)
+            {
+                r[0].samples.push_back(time_ns([&] { return lite_f(lv); }, m_options.min_time));
+                if (count == 2) r[1].samples.push_back(time_ns([&] { return std_f(sv); }, m_options.min_time));
+            }
+            for (std::size_t i = 0; i < 2; ++i)
+            {
+                result& x = r[i];
+                x.name = name;
+                x.member = member;
+                x.char_type = char_name<CharT>();
+                x.pattern = pattern;
+                x.bytes = bytes;
+                x.needle = needle;
+                summarize(x);
+                if (i < count) m_results.push_back(x);
+            }
+            if (m_report) m_report(r[0], r[1], m_context);
+        }
+
+        options m_options;
+        reporter m_report;
+        void* m_context;
+        std::vector<result> m_results;
+    };
+
+    // 編譯器和SIMD級別，寫進JSON的context，回歸檢查用來判斷基線是否可比
+    inline const char* compiler_name()
+    {
+        static char name[32];
+#if defined(__clang__)
+        std::snprintf(name, sizeof(name), "clang %d.%d", __clang_major__, __clang_minor__);
+#elif defined(__GNUC__)
+        std::snprintf(name, sizeof(name), "gcc %d.%d", __GNUC__, __GNUC_MINOR__);
+#elif defined(_MSC_VER)
+        std::snprintf(name, sizeof(name), "msvc %d", _MSC_VER);
+#else
+        std::snprintf(name, sizeof(name), "unknown");
+#endif
+        return name;
+    }
+
+    inline const char* simd_name()
+    {
+#if defined(LITE_AVX2)
+        return "avx2";
+#elif defined(LITE_SSSE3)
+        return "ssse3";
+#elif defined(LITE_SSE2)
+        return "sse2";
+#else
+        return "none";
+#endif
+    }
+
+    inline void write_json(std::FILE* out, const std::vector<result>& results, const options& o)
+    {
+        std::fprintf(out, "{\n  \"context\": {\n");
+        std::fprintf(out, "    \"compiler\": \"%s\",\n", compiler_name());
+        std::fprintf(out, "    \"simd\": \"%s\",\n", simd_name());
+        std::fprintf(out, "    \"min_time\": %g,\n    \"repetitions\": %zu\n  },\n  \"benchmarks\": [\n", o.min_time, o.repetitions);
+        for (std::size_t i = 0; i < results.size(); ++i)
+        {
+            const result& r = results[i];
+            std::fprintf(out,
+                         "    {\"name\": \"%s\", \"member\": \"%s\", \"impl\": \"%s\", \"char\": \"%s\", \"pattern\": \"%s\", "
+                         "\"bytes\": %zu, \"needle\": %zu, \"ns\": %.3f, \"mad\": %.3f, \"gbps\": %.4f}%s\n",
+                         r.name.c_str(), r.member.c_str(), r.impl.c_str(), r.char_type.c_str(), r.pattern.c_str(),
+                         r.bytes, r.needle, r.ns, r.mad, r.gbps, i + 1 < results.size() ? "," : "");
+        }
+        std::fprintf(out, "  ]\n}\n");
+    }
+
+    inline void print_header()
+    {
+        std::printf("%-18s %-9s %-6s %6s %10s %12s %12s %8s\n", "member", "char", "pattern", "needle", "bytes", "lite GB/s", "std GB/s", "speedup");
+    }
+
+    inline void print_row(const result& l, const result& s, void*)
+    {
+        std::printf("%-18s %-9s %-6s %6zu %10zu %12.2f %12.2f %8.2f\n", l.member.c_str(), l.char_type.c_str(), l.pattern.c_str(),
+                    l.needle, l.bytes, l.gbps, s.gbps, s.ns / l.ns);
+        std::fflush(stdout);
+    }
+
+    // 解析--json、--filter、--min-time、--max-bytes，不認識的參數返回false
+    inline bool parse_args(int argc, char* argv[], options& o, bool& json)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string_view arg(argv[i]);
+            if (arg == "--json") json = true;
+            else if (arg == "--filter" && i + 1 < argc) o.filter = argv[++i];
+            else if (arg == "--min-time" && i + 1 < argc) o.min_time = std::atof(argv[++i]);
+            else if (arg == "--max-bytes" && i + 1 < argc) o.max_bytes = static_cast<std::size_t>(std::atoll(argv[++i]));
+            else return false;
+        }
+        return true;
+    }
+}
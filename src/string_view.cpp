@@ -1,9 +1,38 @@
 ﻿#define DOCTEST_CONFIG_IMPLEMENT
 #include <doctest/doctest.h>
 #include <lite/string_view.hpp>
+#include <lite/searcher.hpp>
+#include <lite/multi_searcher.hpp>
+#include <lite/hash.hpp>
+#include <lite/flat_view_map.hpp>
+#include <lite/view_arena.hpp>
+#include <lite/split_view.hpp>
+#include <lite/structural_index.hpp>
+#include <lite/mapped_file.hpp>
+#include <lite/chunked_reader.hpp>
+#include <lite/parse.hpp>
+#include <lite/static_map.hpp>
+#include <lite/ci_string_view.hpp>
+#include <lite/utf8.hpp>
+#include <lite/stats.hpp>
+#include <lite/parallel.hpp>
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cmath>
+#include <ranges>
 #include <cstring>
+#include <iterator>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
 #include <string_view>
 #include <type_traits>
+#include <unordered_map>
+#include <vector>
 
 typedef lite::string_view string_view_t;
 //typedef std::string_view string_view_t;
@@ -59,6 +88,32 @@ TEST_CASE("string_view 4")
     CHECK(std::memcmp(sv.data(), "123", sv.size()) == 0);
 }
 
+TEST_CASE("iterator")
+{
+    typedef lite::string_view::const_iterator iterator;
+    static_assert(std::is_trivially_copyable<iterator>::value, "");
+    static_assert(std::is_trivially_copyable<LegacyRandomAccessIterator<lite::basic_string_view_const_iterator<char> > >::value, "");
+#if LITE_CONTIGUOUS_ITERATOR
+    static_assert(std::contiguous_iterator<iterator>, "");
+    static_assert(std::ranges::contiguous_range<lite::string_view>, "");
+    CHECK(std::to_address(lite::string_view("abc").begin()) != NULLPTR);
+#endif
+
+    const char text[] = "hello, world";
+    lite::string_view sv(text);
+    CHECK(&*sv.begin() == text);
+    CHECK(sv.end() - sv.begin() == 12);
+    CHECK(std::find(sv.begin(), sv.end(), ',') - sv.begin() == 5);
+    CHECK(std::count(sv.cbegin(), sv.cend(), 'o') == 2);
+    CHECK(std::equal(sv.begin(), sv.begin() + 5, "hello"));
+    CHECK(std::string(sv.rbegin(), sv.rend()) == "dlrow ,olleh");
+    CHECK(*sv.crbegin() == 'd');
+    char out[12];
+    std::copy(sv.begin(), sv.end(), out);
+    CHECK(std::memcmp(out, text, 12) == 0);
+    CHECK(std::ranges::find(sv, 'w') - sv.begin() == 7);
+}
+
 TEST_CASE("empty")
 {
     string_view_t sv;
@@ -219,6 +274,183 @@ TEST_CASE("find")
     CHECK(sv.find("34", 1) == 2); // 4
 }
 
+TEST_CASE("find char")
+{
+    std::string str(100, 'a');
+    str[70] = 'b';
+    str[90] = 'b';
+    string_view_t sv(str.c_str(), str.size());
+    std::string_view sv_s(str.c_str(), str.size());
+
+    for (std::size_t pos = 0; pos <= str.size() + 1; ++pos)
+    {
+        CHECK(sv.find('b', pos) == sv_s.find('b', pos));
+        CHECK(sv.rfind('b', pos) == sv_s.rfind('b', pos));
+        CHECK(sv.find('c', pos) == sv_s.find('c', pos));
+        CHECK(sv.rfind('a', pos) == sv_s.rfind('a', pos));
+    }
+    CHECK(string_view_t().find('a') == std::string_view().find('a'));
+    CHECK(string_view_t().rfind('a') == std::string_view().rfind('a'));
+
+    std::u16string u16(40, u'a');
+    u16[33] = u'\x4e2d';
+    lite::basic_string_view<char16_t> sv16(u16.c_str(), u16.size());
+    CHECK(sv16.find(u'\x4e2d') == 33);
+    CHECK(sv16.rfind(u'a') == 39);
+    CHECK(sv16.rfind(u'\x4e2d', 32) == std::u16string::npos);
+
+    std::u32string u32(40, U'a');
+    u32[5] = U'\x1f600';
+    lite::basic_string_view<char32_t> sv32(u32.c_str(), u32.size());
+    CHECK(sv32.find(U'\x1f600') == 5);
+    CHECK(sv32.rfind(U'\x1f600') == 5);
+    CHECK(sv32.contains(U'\x1f600'));
+}
+
+TEST_CASE("find substring")
+{
+    std::string str;
+    for (int i = 0; i < 2000; ++i)
+    {
+        str += static_cast<char>('a' + (i * 7 + i / 13) % 5);
+    }
+    string_view_t sv(str.c_str(), str.size());
+    std::string_view sv_s(str.c_str(), str.size());
+
+    std::size_t lengths[] = { 2, 5, 12, 13, 40, 256, 257, 600 };
+    for (std::size_t i = 0; i < sizeof(lengths) / sizeof(lengths[0]); ++i)
+    {
+        std::string hit = str.substr(1234, lengths[i]);
+        std::string miss = hit;
+        miss[miss.size() / 2] = 'z';
+        CHECK(sv.find(string_view_t(hit.c_str(), hit.size())) == sv_s.find(hit));
+        CHECK(sv.find(string_view_t(hit.c_str(), hit.size()), 1000) == sv_s.find(hit, 1000));
+        CHECK(sv.find(string_view_t(miss.c_str(), miss.size())) == sv_s.find(miss));
+    }
+
+    std::string periodic(1000, 'a');
+    std::string needle(300, 'a');
+    needle[299] = 'b';
+    CHECK(string_view_t(periodic.c_str(), periodic.size()).find(string_view_t(needle.c_str(), needle.size())) == std::string::npos);
+    periodic[700] = 'b';
+    CHECK(string_view_t(periodic.c_str(), periodic.size()).find(string_view_t(needle.c_str(), needle.size())) == 401);
+
+    // 每輪只移動一個字符，中途轉到Two-Way
+    std::string dense(20000, 'a');
+    dense[15000] = 'b';
+    std::string dense_needle(32, 'a');
+    dense_needle[31] = 'b';
+    CHECK(string_view_t(dense.c_str(), dense.size()).find(string_view_t(dense_needle.c_str(), dense_needle.size())) == 14969);
+    dense_needle[30] = 'b';
+    CHECK(string_view_t(dense.c_str(), dense.size()).find(string_view_t(dense_needle.c_str(), dense_needle.size())) == std::string::npos);
+    // 轉換前後、文本末尾的匹配都能找到，與std的結果一致
+    dense_needle[30] = 'a';
+    const lite::pair_horspool<char> horspool(dense_needle.c_str(), dense_needle.size());
+    for (std::size_t at : { std::size_t(100), std::size_t(1500), std::size_t(8000), dense.size() - 1 })
+    {
+        std::string text(dense.size(), 'a');
+        text[at] = 'b';
+        const char* p = horspool.find(text.c_str(), text.size());
+        CHECK(p != NULLPTR);
+        CHECK(static_cast<std::size_t>(p - text.c_str()) == text.find(dense_needle));
+    }
+
+    CHECK(sv.find(string_view_t(), 7) == 7);
+    CHECK(sv.find(string_view_t("ab"), str.size() + 1) == sv_s.find("ab", str.size() + 1));
+
+    std::u16string u16(500, u'x');
+    u16.replace(300, 3, u"\x4e2d\x6587x");
+    lite::basic_string_view<char16_t> sv16(u16.c_str(), u16.size());
+    CHECK(sv16.find(lite::basic_string_view<char16_t>(u"\x4e2d\x6587")) == 300);
+    CHECK(sv16.find(lite::basic_string_view<char16_t>(u16.c_str() + 290, 100)) == 290);
+}
+
+TEST_CASE("searcher")
+{
+    std::string str("key=value; key=other; keys=none; key=");
+    lite::string_view sv(str.c_str(), str.size());
+
+    lite::searcher<char> s(lite::string_view("key="));
+    CHECK(s.find(sv) == 0);
+    CHECK(s.find(sv, 1) == 11);
+    CHECK(s.count(sv) == 3);
+    CHECK(s.contains(sv));
+    CHECK_FALSE(s.contains(lite::string_view("keys")));
+
+    std::vector<std::size_t> all;
+    s.find_all(sv, std::back_inserter(all));
+    CHECK(all.size() == 3);
+    CHECK(all[2] == str.size() - 4);
+
+    lite::searcher<char> copy = s;
+    CHECK(copy.find(sv, 12) == str.size() - 4);
+
+    std::string needle(str, 5, 20);
+    lite::searcher<char> mid(lite::string_view(needle.c_str(), needle.size()));
+    CHECK(mid.find(sv) == 5);
+
+    std::string::iterator it = std::search(str.begin(), str.end(), lite::searcher<char>(lite::string_view("keys")));
+    CHECK(it - str.begin() == 22);
+    CHECK(std::search(sv.begin(), sv.end(), lite::searcher<char>(lite::string_view("none"))) - sv.begin() == 27);
+
+    CHECK(lite::searcher<char>(lite::string_view("aa")).count(lite::string_view("aaaaa")) == 2);
+    CHECK(lite::searcher<char>().count(lite::string_view("abc")) == 4);
+
+    // Horspool和Two-Way共用存儲，複製後各自仍可用
+    std::string text(5000, 'x');
+    const std::string medium(40, 'm');
+    const std::string large = std::string(299, 'l') + "L";
+    text.replace(1000, medium.size(), medium);
+    text.replace(3000, large.size(), large);
+    const lite::string_view tv(text.data(), text.size());
+    const lite::searcher<char> horspool(lite::string_view(medium.data(), medium.size()));
+    const lite::searcher<char> two_way(lite::string_view(large.data(), large.size()));
+    lite::searcher<char> copies[2] = { horspool, two_way };
+    CHECK(copies[0].find(tv) == 1000);
+    CHECK(copies[1].find(tv) == 3000);
+    copies[0] = two_way;
+    CHECK(copies[0].find(tv, 3001) == std::string::npos);
+    CHECK(sizeof(lite::searcher<char>) < sizeof(lite::two_way<char, std::char_traits<char> >) + sizeof(lite::pair_horspool<char>));
+    CHECK(sizeof(lite::two_way<char, std::char_traits<char> >) <= 256 * 4 + 64);
+}
+
+TEST_CASE("multi_searcher")
+{
+    lite::string_view keywords[] = { "he", "she", "his", "hers", "" };
+    lite::multi_searcher ms(keywords, keywords + 5);
+    CHECK(ms.size() == 5);
+    CHECK(ms.dense());
+
+    lite::string_view text("ushers and his hershey");
+    typedef lite::multi_searcher::match match_t;
+
+    match_t first;
+    CHECK(ms.find_first(text, first));
+    CHECK(first.needle == 1);
+    CHECK(first.offset == 1);
+    CHECK(ms.contains_any(text));
+    CHECK_FALSE(ms.contains_any(lite::string_view("nothing to see")));
+
+    std::vector<match_t> all;
+    ms.find(text, lite::multi_searcher::all_matches, std::back_inserter(all));
+    CHECK(all.size() == 8);
+    CHECK(all[1].needle == 0);
+    CHECK(all[1].offset == 2);
+    CHECK(all[2].needle == 3);
+    CHECK(all[2].offset == 2);
+
+    std::vector<match_t> longest;
+    ms.find(text, lite::multi_searcher::leftmost_longest, std::back_inserter(longest));
+    CHECK(longest.size() == 4);
+    CHECK(longest[0].needle == 1);
+    CHECK(longest[1].needle == 2);
+    CHECK(longest[1].offset == 11);
+    CHECK(longest[2].needle == 3);
+    CHECK(longest[2].offset == 15);
+    CHECK(longest[3].needle == 0);
+    CHECK(longest[3].offset == 19);
+}
+
 TEST_CASE("contains")
 {
     string_view_t sv("12345");
@@ -236,6 +468,26 @@ TEST_CASE("rfind")
 
     std::string_view sv_s("123412");
     CHECK(sv_s.rfind(std::string_view("12")) == 4); // 1
+
+    CHECK(sv.rfind(string_view_t("12"), 3) == 0);
+    CHECK(sv.rfind(string_view_t("12"), 4) == 4);
+    CHECK(sv.rfind('4', 2) == sv_s.rfind('4', 2)); // 2
+    CHECK(sv.rfind("341", 5, 2) == 2); // 3
+    CHECK(sv.rfind("41", 2) == sv_s.rfind("41", 2)); // 4
+    CHECK(sv.rfind("") == 6);
+    CHECK(sv.rfind("", 2) == 2);
+
+    std::string str(3000, 'a');
+    str.replace(100, 3, "abc");
+    str.replace(2500, 3, "abc");
+    std::string needle = str.substr(90, 300);
+    string_view_t sv2(str.c_str(), str.size());
+    std::string_view sv2_s(str.c_str(), str.size());
+    CHECK(sv2.rfind(string_view_t(needle.c_str(), needle.size())) == 2490);
+    CHECK(sv2.rfind(string_view_t(needle.c_str(), needle.size()), 2489) == 90);
+    CHECK(sv2.rfind(string_view_t("abc")) == 2500);
+    CHECK(sv2.rfind(string_view_t("abc"), 2499) == 100);
+    CHECK(sv2.rfind(string_view_t("aaaaaaaaaaaaaaaaaaaaaaaaaaaaab"), 1000) == sv2_s.rfind("aaaaaaaaaaaaaaaaaaaaaaaaaaaaab", 1000));
 }
 
 TEST_CASE("find_first_of")
@@ -245,6 +497,100 @@ TEST_CASE("find_first_of")
     CHECK(sv.find_first_of(string_view_t("12")) == 0); // 1
 }
 
+TEST_CASE("char_set")
+{
+    std::string str(100, 'x');
+    str[20] = ',';
+    str[75] = '\t';
+    string_view_t sv(str.c_str(), str.size());
+    std::string_view sv_s(str.c_str(), str.size());
+
+    lite::char_set delims(",;\t");
+    CHECK(delims.size() == 3);
+    CHECK(delims.contains(';'));
+    CHECK_FALSE(delims.contains('x'));
+
+    CHECK(sv.find_first_of(delims) == 20);
+    CHECK(sv.find_first_of(delims, 21) == 75);
+    CHECK(sv.find_first_of(delims, 76) == sv_s.find_first_of(",;\t", 76));
+    CHECK(sv.find_last_of(delims) == 75);
+    CHECK(sv.find_last_of(delims, 74) == 20);
+    CHECK(sv.find_first_not_of(lite::char_set("x")) == 20);
+    CHECK(sv.find_last_not_of(lite::char_set("x\t")) == 20);
+
+    CHECK(sv.find_first_of(",;\t", 21) == sv_s.find_first_of(",;\t", 21));
+    CHECK(sv.find_last_of("\xff\x80,") == sv_s.find_last_of("\xff\x80,"));
+    CHECK(sv.find_first_not_of("x,") == sv_s.find_first_not_of("x,"));
+    CHECK(sv.find_first_of("yz") == sv_s.find_first_of("yz"));
+
+    // 預先建好的char_set與直接傳字符串結果一致：pshufb表、small_set和位圖三種路徑，文本長於32字節
+    std::string text;
+    for (int i = 0; i < 300; ++i) text += static_cast<char>((i * 37 + 11) & 0xFF);
+    const string_view_t tv(text.data(), text.size());
+    const char* sets[] = {
+        ",;\t|", "\x01\x12\x23\x34\x45\x56\x67\x78\x89\x9a", "abcdefghijklmnop",
+        "\x05\x15\x25\x35\x45\x55\x65\x75\x85\x95\xa5\xb5\xc5\xd5\xe5\xf5\xff", "\xfe", ""
+    };
+    for (const char* chars : sets)
+    {
+        const string_view_t v(chars);
+        const lite::char_set set(v);
+        CHECK(set.size() == v.size());
+        for (std::size_t pos = 0; pos <= text.size(); pos += 29)
+        {
+            CHECK(tv.find_first_of(set, pos) == tv.find_first_of(v, pos));
+            CHECK(tv.find_first_not_of(set, pos) == tv.find_first_not_of(v, pos));
+            CHECK(tv.find_last_of(set, pos) == tv.find_last_of(v, pos));
+            CHECK(tv.find_last_not_of(set, pos) == tv.find_last_not_of(v, pos));
+            CHECK(tv.find_first_of(set, pos) == std::string_view(text).find_first_of(std::string_view(chars), pos));
+            CHECK(tv.find_last_not_of(set, pos) == std::string_view(text).find_last_not_of(std::string_view(chars), pos));
+        }
+    }
+}
+
+// simd::small_set的四個方向與逐個字符比較的結果一致，覆蓋向量塊內各位置和尾部
+template <typename T>
+static void check_small_set()
+{
+    typedef lite::simd::small_set<T> set_t;
+    std::basic_string<T> text;
+    for (int i = 0; i < 200; ++i) text += static_cast<T>('a' + (i * 7) % 26);
+    const std::basic_string<T> letters(text.begin(), text.begin() + 26);
+    for (std::size_t m = 1; m <= set_t::max_size; ++m)
+    {
+        const std::basic_string<T> set(letters, 0, m);
+        const std::basic_string_view<T> sv(set);
+        for (std::size_t n = 0; n <= text.size(); n += 13)
+        {
+            const std::basic_string_view<T> h(text.data(), n);
+            const T* p = set_t::template find_first<true>(text.data(), n, set.data(), m);
+            CHECK((p == NULLPTR ? std::string::npos : static_cast<std::size_t>(p - text.data())) == h.find_first_of(sv));
+            p = set_t::template find_first<false>(text.data(), n, set.data(), m);
+            CHECK((p == NULLPTR ? std::string::npos : static_cast<std::size_t>(p - text.data())) == h.find_first_not_of(sv));
+            p = set_t::template find_last<true>(text.data(), n, set.data(), m);
+            CHECK((p == NULLPTR ? std::string::npos : static_cast<std::size_t>(p - text.data())) == h.find_last_of(sv));
+            p = set_t::template find_last<false>(text.data(), n, set.data(), m);
+            CHECK((p == NULLPTR ? std::string::npos : static_cast<std::size_t>(p - text.data())) == h.find_last_not_of(sv));
+        }
+    }
+}
+
+TEST_CASE("small_set")
+{
+    check_small_set<char>();
+    check_small_set<char16_t>();
+    check_small_set<char32_t>();
+
+    // 沒有SSSE3時char的小集合也走small_set
+    std::string csv(1000, 'x');
+    csv[700] = ';';
+    csv[900] = '\n';
+    string_view_t sv(csv.c_str(), csv.size());
+    CHECK(sv.find_first_of(string_view_t(",;\n\"")) == 700);
+    CHECK(sv.find_last_of(string_view_t(",;\n\"")) == 900);
+    CHECK(sv.find_first_not_of(string_view_t("x;")) == 900);
+}
+
 TEST_CASE("find_last_of")
 {
     string_view_t sv("123412");
@@ -270,6 +616,933 @@ TEST_CASE("find_last_not_of")
     CHECK(sv.find_last_not_of(string_view_t("12")) == sv_s.find_last_not_of(std::string_view("12"))); // 1
 }
 
+TEST_CASE("hash")
+{
+    std::string a("group-by-key");
+    std::string b("group-by-key");
+    lite::hash<lite::string_view> h;
+    CHECK(h(lite::string_view(a.c_str(), a.size())) == h(lite::string_view(b.c_str(), b.size())));
+    CHECK(h(lite::string_view("abc")) != h(lite::string_view("abd")));
+    CHECK(h(lite::string_view()) == h(lite::string_view("")));
+    CHECK(lite::hash_bytes("a", 1, 1) == 0xc5bac3db178713c4ull);
+
+    lite::hash<lite::string_view> seeded(42);
+    CHECK(seeded(lite::string_view("abc")) != h(lite::string_view("abc")));
+
+    std::unordered_map<lite::string_view, int> map;
+    map[lite::string_view(a.c_str(), a.size())] = 1;
+    map[lite::string_view("other")] = 2;
+    CHECK(map[lite::string_view(b.c_str(), b.size())] == 1);
+    CHECK(map.size() == 2);
+
+    std::u16string u(u"key");
+    CHECK(std::hash<lite::basic_string_view<char16_t>>()(lite::basic_string_view<char16_t>(u.c_str(), u.size()))
+        == lite::hash_bytes(u.c_str(), u.size() * sizeof(char16_t)));
+}
+
+TEST_CASE("flat_view_map")
+{
+    std::vector<std::string> keys;
+    for (int i = 0; i < 1000; ++i)
+    {
+        keys.push_back("key-" + std::to_string(i));
+    }
+
+    lite::flat_view_map<int> map;
+    for (int i = 0; i < 1000; ++i)
+    {
+        CHECK(map.insert(lite::string_view(keys[i].data(), keys[i].size()), i).second);
+    }
+    CHECK(map.size() == 1000);
+    CHECK(!map.insert(lite::string_view("key-7"), 0).second);
+    CHECK(*map.find("key-7") == 7);
+    CHECK(*map.find(std::string("key-999")) == 999);
+    CHECK(map.find("key-1000") == nullptr);
+
+    for (int i = 0; i < 1000; i += 2)
+    {
+        CHECK(map.erase(lite::string_view(keys[i].data(), keys[i].size())) == 1);
+    }
+    CHECK(map.erase(lite::string_view("key-0")) == 0);
+    CHECK(map.size() == 500);
+    CHECK(!map.contains("key-0"));
+    CHECK(map.contains("key-1"));
+
+    int sum = 0;
+    for (lite::flat_view_map<int>::const_iterator it = map.begin(); it != map.end(); ++it)
+    {
+        CHECK(it->key().size() >= 5);
+        sum += it->value;
+    }
+    CHECK(sum == 250000);
+
+    // 短鍵複製進槽，不再引用原來的內存
+    lite::flat_view_map<int, 15> inline_map;
+    {
+        std::string temp("short");
+        inline_map[lite::string_view(temp.data(), temp.size())] = 1;
+    }
+    for (int i = 0; i < 100; ++i)
+    {
+        inline_map[lite::string_view(keys[i].data(), keys[i].size())] = i;
+    }
+    CHECK(inline_map["short"] == 1);
+    CHECK(inline_map.size() == 101);
+}
+
+TEST_CASE("view_arena")
+{
+    lite::view_arena arena(256, 8);
+    lite::string_view kept;
+    {
+        std::string temp("temporary input");
+        kept = arena.store(lite::string_view(temp.data(), temp.size()));
+    }
+    CHECK(kept == lite::string_view("temporary input"));
+    CHECK(reinterpret_cast<std::size_t>(kept.data()) % 8 == 0);
+    CHECK(arena.store(lite::string_view()).empty());
+
+    std::vector<std::string> input;
+    for (int i = 0; i < 100; ++i)
+    {
+        input.push_back("value-" + std::to_string(i));
+    }
+    std::vector<lite::string_view> views;
+    arena.store_many(input.begin(), input.end(), std::back_inserter(views));
+    input.clear();
+    CHECK(views.size() == 100);
+    CHECK(views[42] == lite::string_view("value-42"));
+
+    std::string large(1000, 'x');
+    CHECK(arena.store(large).size() == 1000);
+
+    lite::view_arena::statistics s = arena.stats();
+    CHECK(s.stored == 102);
+    CHECK(s.used == 15 + 790 + 1000);
+    CHECK(s.reserved >= s.used + s.padding + s.wasted);
+
+    // reset後保留普通塊，釋放大塊
+    lite::view_arena::size_type slabs = arena.bytes_reserved() - 1008;
+    arena.reset();
+    CHECK(arena.bytes_used() == 0);
+    CHECK(arena.bytes_reserved() == slabs);
+    CHECK(arena.store("again") == lite::string_view("again"));
+    CHECK(arena.bytes_reserved() == slabs);
+
+    lite::basic_string_view<char16_t> wide = arena.store(lite::basic_string_view<char16_t>(u"wide"));
+    CHECK(wide.size() == 4);
+    CHECK(reinterpret_cast<std::size_t>(wide.data()) % 8 == 0);
+}
+
+TEST_CASE("split_view")
+{
+    typedef std::vector<lite::string_view> tokens;
+    lite::string_view line("a,b,,c,");
+
+    auto by_char = lite::split(line, ',');
+    CHECK(tokens(by_char.begin(), by_char.end()) == tokens{"a", "b", "", "c", ""});
+
+    auto skipped = lite::split(line, ',', lite::skip_empty);
+    CHECK(tokens(skipped.begin(), skipped.end()) == tokens{"a", "b", "c"});
+
+    auto limited = lite::split(line, ',', lite::keep_empty, 2);
+    CHECK(tokens(limited.begin(), limited.end()) == tokens{"a", "b", ",c,"});
+
+    auto by_string = lite::split(lite::string_view("k1 => v1 => v2"), " => ");
+    CHECK(tokens(by_string.begin(), by_string.end()) == tokens{"k1", "v1", "v2"});
+
+    auto by_any = lite::split_any(lite::string_view("x y\tz\n"), " \t\n", lite::skip_empty);
+    CHECK(tokens(by_any.begin(), by_any.end()) == tokens{"x", "y", "z"});
+
+    auto by_pred = lite::split_if(lite::string_view("12a34b5"), [](char c) { return c >= 'a'; });
+    CHECK(tokens(by_pred.begin(), by_pred.end()) == tokens{"12", "34", "5"});
+
+    auto empty = lite::split(lite::string_view(), ',');
+    CHECK(std::distance(empty.begin(), empty.end()) == 1);
+    auto empty_skipped = lite::split(lite::string_view(), ',', lite::skip_empty);
+    CHECK(empty_skipped.begin() == empty_skipped.end());
+
+    static_assert(std::ranges::forward_range<decltype(by_char)>);
+    static_assert(std::ranges::view<decltype(by_char)>);
+    int count = 0;
+    for (lite::string_view token : lite::split(line, ',') | std::views::filter([](lite::string_view t) { return !t.empty(); }) | std::views::take(2))
+    {
+        CHECK(token.size() == 1);
+        ++count;
+    }
+    CHECK(count == 2);
+}
+
+TEST_CASE("structural_index")
+{
+    std::string csv = "id,name,note\r\n"
+                      "1,\"Smith, J\",\"said \"\"hi\"\"\"\r\n"
+                      "2,\"multi\nline\",\n"
+                      "3,last,";
+    // 跨過64字節的塊邊界
+    csv += std::string(100, 'x') + "\n4,\"" + std::string(70, ',') + "\",end";
+
+    lite::structural_index index(lite::string_view(csv.data(), csv.size()));
+    CHECK(index.size() == 5);
+    CHECK(!index.unterminated_quote());
+
+    lite::structural_index::record header = index[0];
+    CHECK(header.size() == 3);
+    CHECK(header[2].value() == lite::string_view("note"));
+
+    lite::structural_index::record r1 = index[1];
+    CHECK(r1[1].quoted());
+    CHECK(r1[1].value() == lite::string_view("Smith, J"));
+    CHECK(r1[2].escaped());
+    std::string note;
+    r1[2].unescape(note);
+    CHECK(note == "said \"hi\"");
+
+    CHECK(index[2][1].value() == lite::string_view("multi\nline"));
+    CHECK(index[2][2].raw().empty());
+    CHECK(index[3][2].value().size() == 100);
+    CHECK(index[4][1].value().size() == 70);
+    CHECK(index[4][2].value() == lite::string_view("end"));
+
+    std::size_t fields = 0;
+    for (lite::structural_index::iterator it = index.begin(); it != index.end(); ++it)
+    {
+        lite::structural_index::record r = *it;
+        for (lite::structural_index::record::iterator f = r.begin(); f != r.end(); ++f)
+        {
+            ++fields;
+        }
+    }
+    CHECK(fields == 15);
+    CHECK(index.quotes().size() == 12);
+
+    lite::structural_index tsv('\t');
+    tsv.build(lite::string_view("a\tb\nc\td\n"));
+    CHECK(tsv.size() == 2);
+    CHECK(tsv[1][1].value() == lite::string_view("d"));
+
+    tsv.build(lite::string_view("a\t\"open"));
+    CHECK(tsv.unterminated_quote());
+    CHECK(tsv.size() == 1);
+    CHECK(lite::structural_index(lite::string_view()).empty());
+}
+
+TEST_CASE("mapped_file")
+{
+    const char* path = "lite_mapped_file_test.txt";
+    {
+        std::ofstream out(path, std::ios::binary);
+        out << "first\nsecond\r\n\nlast";
+    }
+
+    {
+        lite::mapped_file file(path, lite::mapped_file::sequential | lite::mapped_file::huge_pages);
+        CHECK(file.is_open());
+        CHECK(file.size() == 19);
+        CHECK(file.view().starts_with(lite::string_view("first\n")));
+
+        std::vector<lite::string_view> lines;
+        for (lite::string_view line : file.lines())
+        {
+            lines.push_back(line);
+        }
+        CHECK(lines == std::vector<lite::string_view>{"first", "second\r", "", "last"});
+
+        lite::mapped_file moved(std::move(file));
+        CHECK(!file.is_open());
+        CHECK(moved.view().ends_with(lite::string_view("last")));
+    }
+    std::remove(path);
+
+    CHECK_THROWS_AS(lite::mapped_file("lite_mapped_file_missing.txt"), std::runtime_error);
+
+    auto empty = lite::lines(lite::string_view());
+    CHECK(empty.begin() == empty.end());
+    auto trailing = lite::lines(lite::string_view("a\n"));
+    CHECK(std::distance(trailing.begin(), trailing.end()) == 1);
+
+    CHECK(lite::string_view().max_size() > 0xFFFFFFFFull || sizeof(std::size_t) == 4);
+}
+
+TEST_CASE("chunked_reader")
+{
+    std::string text;
+    for (int i = 0; i < 500; ++i)
+    {
+        text += "record-" + std::to_string(i * 7919) + "\n";
+    }
+    text += "tail";
+
+    // 小塊讓大部分記錄跨塊
+    std::istringstream in(text);
+    lite::chunked_reader<lite::istream_source> reader(lite::istream_source(in), 13, '\n', 32);
+    std::vector<std::string> records;
+    lite::string_view record;
+    while (reader.next(record))
+    {
+        records.push_back(std::string(record.data(), record.size()));
+    }
+    CHECK(records.size() == 501);
+    CHECK(records[0] == "record-0");
+    CHECK(records[499] == "record-" + std::to_string(499 * 7919));
+    CHECK(records[500] == "tail");
+    CHECK(reader.bytes_read() == text.size());
+    CHECK(reader.memory() == 2 * (13 + 32));
+
+    std::istringstream in2(text);
+    auto blocks = lite::make_chunked_reader(lite::istream_source(in2), 64);
+    std::string joined;
+    lite::string_view block;
+    while (blocks.next_block(block))
+    {
+        CHECK((block.ends_with('\n') || block == lite::string_view("tail")));
+        joined.append(block.data(), block.size());
+    }
+    CHECK(joined == text);
+
+    // 每次只讀5字節：跨很多次讀取的長記錄只從上次掃描到的地方接着找
+    struct trickle
+    {
+        const std::string* text;
+        std::size_t pos;
+        std::size_t operator()(char* buffer, std::size_t size)
+        {
+            const std::size_t n = std::min(std::min(size, std::size_t(5)), text->size() - pos);
+            std::memcpy(buffer, text->data() + pos, n);
+            pos += n;
+            return n;
+        }
+    };
+    const std::string long_records = std::string(700, 'a') + "\n" + std::string(900, 'b') + "\nc\n" + std::string(300, 'd');
+    trickle slow = { &long_records, 0 };
+    lite::chunked_reader<trickle> slow_reader(slow, 64, '\n', 1024);
+    std::vector<std::size_t> lengths;
+    while (slow_reader.next(record)) lengths.push_back(record.size());
+    CHECK(lengths == std::vector<std::size_t>{ 700, 900, 1, 300 });
+    trickle slow2 = { &long_records, 0 };
+    lite::chunked_reader<trickle> slow_blocks(slow2, 64, '\n', 1024);
+    joined.clear();
+    while (slow_blocks.next_block(block)) joined.append(block.data(), block.size());
+    CHECK(joined == long_records);
+
+    std::istringstream in3(std::string(100, 'x') + "\n");
+    lite::chunked_reader<lite::istream_source> bounded(lite::istream_source(in3), 16, '\n', 16);
+    CHECK_THROWS_AS(bounded.next(record), std::length_error);
+}
+
+TEST_CASE("parse_int")
+{
+    lite::parse_result<int> r = lite::parse_int<int>(lite::string_view("-123456789,next"));
+    CHECK(r.ok());
+    CHECK(r.value == -123456789);
+    CHECK(r.length == 10);
+
+    CHECK(lite::parse_int<unsigned long long>(lite::string_view("18446744073709551615")).value == 18446744073709551615ull);
+    CHECK(lite::parse_int<unsigned long long>(lite::string_view("18446744073709551616")).error == lite::parse_out_of_range);
+    CHECK(lite::parse_int<long long>(lite::string_view("-9223372036854775808")).value == std::numeric_limits<long long>::min());
+    CHECK(lite::parse_int<signed char>(lite::string_view("128")).error == lite::parse_out_of_range);
+    CHECK(lite::parse_int<unsigned>(lite::string_view("-1")).error == lite::parse_invalid);
+    CHECK(lite::parse_int<int>(lite::string_view("0000000000000000000000042")).value == 42);
+    CHECK(lite::parse_int<int>(lite::string_view("x1")).error == lite::parse_invalid);
+    CHECK(lite::parse_int<int>(lite::string_view()).length == 0);
+
+    lite::string_view column[] = { "1", "22", "333", "4x", "" };
+    int out[5];
+    lite::parse_errc errors[5];
+    CHECK(lite::parse_int_batch(column, 5, out, errors) == 2);
+    CHECK(out[2] == 333);
+    CHECK(out[3] == 0);
+    CHECK(errors[3] == lite::parse_invalid);
+}
+
+// m * 2^e2的精確十進制表示
+static std::string exact_decimal(unsigned long long m, int e2)
+{
+    std::vector<unsigned> digits; // 低位在前
+    for (; m != 0; m /= 10) digits.push_back(static_cast<unsigned>(m % 10));
+    const int scale = e2 < 0 ? -e2 : 0;
+    for (int i = 0; i < (e2 < 0 ? -e2 : e2); ++i)
+    {
+        // e2 < 0時乘5再除以10^scale
+        unsigned carry = 0;
+        for (unsigned& d : digits)
+        {
+            unsigned t = d * (e2 < 0 ? 5 : 2) + carry;
+            d = t % 10;
+            carry = t / 10;
+        }
+        for (; carry != 0; carry /= 10) digits.push_back(carry % 10);
+    }
+    while (digits.size() <= static_cast<std::size_t>(scale)) digits.push_back(0);
+    std::string s;
+    for (std::size_t i = digits.size(); i-- > 0;)
+    {
+        s += static_cast<char>('0' + digits[i]);
+        if (i == static_cast<std::size_t>(scale) && scale != 0) s += '.';
+    }
+    return s;
+}
+
+// x與下一個可表示值的中點，以及略大、略小於中點的十進制串，逐個與std::from_chars比較
+template <typename T, typename Bits>
+static void check_halfway(T x)
+{
+    const int mantissa_bits = std::numeric_limits<T>::digits - 1;
+    const int bias = std::numeric_limits<T>::max_exponent - 1;
+    Bits bits;
+    std::memcpy(&bits, &x, sizeof(x));
+    const unsigned long long fraction = bits & ((Bits(1) << mantissa_bits) - 1);
+    const int biased = static_cast<int>(bits >> mantissa_bits);
+    const unsigned long long m = biased == 0 ? fraction : fraction | (1ULL << mantissa_bits);
+    const int e2 = (biased == 0 ? 1 : biased) - bias - mantissa_bits;
+
+    const std::string halfway = exact_decimal(2 * m + 1, e2 - 1);
+    std::string above = halfway + (halfway.find('.') == std::string::npos ? ".0001" : "0001");
+    std::string below = halfway;
+    if (below.back() != '0')
+    {
+        --below.back();
+        below += below.find('.') == std::string::npos ? ".9" : "9";
+    }
+    for (const std::string& s : { halfway, above, below })
+    {
+        T expected = 0;
+        if (std::from_chars(s.data(), s.data() + s.size(), expected).ec == std::errc::result_out_of_range)
+        {
+            expected = s.compare(0, 2, "0.") == 0 ? T(0) : std::numeric_limits<T>::infinity();
+        }
+        lite::parse_result<T> r = lite::parse_float<T>(lite::string_view(s.data(), s.size()));
+        CHECK(r.length == s.size());
+        CHECK(std::memcmp(&r.value, &expected, sizeof(T)) == 0);
+    }
+}
+
+TEST_CASE("parse_float")
+{
+    lite::parse_result<double> r = lite::parse_float<double>(lite::string_view("3.14159e2;"));
+    CHECK(r.ok());
+    CHECK(r.value == 314.159);
+    CHECK(r.length == 9);
+
+    // 與std::from_chars逐位比較
+    const char* inputs[] = {
+        "0.1", "-0", "1e-400", "2.2250738585072011e-308", "4.9406564584124654e-324",
+        "1.7976931348623157e308", "9007199254740993", "123456789012345678901234567890",
+        "1.00000000000000011102230246251565404236316680908203125", "5.", ".5e-1", "1e", "7e22"
+    };
+    for (const char* s : inputs)
+    {
+        double expected = 0;
+        std::from_chars(s, s + std::strlen(s), expected);
+        lite::parse_result<double> d = lite::parse_float<double>(lite::string_view(s));
+        CHECK(d.ok());
+        CHECK(std::memcmp(&d.value, &expected, sizeof(double)) == 0);
+
+        float expected_float = 0;
+        if (std::from_chars(s, s + std::strlen(s), expected_float).ec == std::errc())
+        {
+            CHECK(lite::parse_float<float>(lite::string_view(s)).value == expected_float);
+        }
+    }
+    // 超過19位有效數字時後備轉換不含符號，符號另外加上
+    const double above = 9007199254740994.0;
+    lite::parse_result<double> plus = lite::parse_float<double>(lite::string_view("+9007199254740993.0000000000000001"));
+    CHECK(plus.ok());
+    CHECK(plus.value == above);
+    CHECK(plus.length == 34);
+    lite::parse_result<double> minus = lite::parse_float<double>(lite::string_view("-9007199254740993.0000000000000001"));
+    CHECK(minus.ok());
+    CHECK(minus.value == -above);
+    CHECK(lite::parse_float<float>(lite::string_view("+16777217.000000000000000000001")).value == 16777218.0f);
+
+    // 超過19位有效數字、落在舍入邊界附近的輸入走大整數比較
+    const double doubles[] = {
+        9007199254740992.0, 1e23, 0.1, 1.0 / 3, 0.0, std::numeric_limits<double>::denorm_min(),
+        std::numeric_limits<double>::min(), std::nextafter(std::numeric_limits<double>::min(), 0.0),
+        std::numeric_limits<double>::max(), std::nextafter(std::numeric_limits<double>::max(), 0.0), 1e-300, 7e300
+    };
+    for (double x : doubles) check_halfway<double, unsigned long long>(x);
+    const float floats[] = {
+        16777216.0f, 0.1f, 0.0f, std::numeric_limits<float>::denorm_min(), std::numeric_limits<float>::min(),
+        std::numeric_limits<float>::max(), 3e-40f, 1e30f
+    };
+    for (float x : floats) check_halfway<float, unsigned>(x);
+    unsigned long long state = 0x9E3779B97F4A7C15ull;
+    for (int i = 0; i < 300; ++i)
+    {
+        state = state * 6364136223846793005ull + 1442695040888963407ull;
+        unsigned long long bits = state >> 1;
+        double x;
+        std::memcpy(&x, &bits, sizeof(x));
+        if (std::isfinite(x) && x != std::numeric_limits<double>::max()) check_halfway<double, unsigned long long>(x);
+        unsigned fbits = static_cast<unsigned>(state >> 33);
+        float f;
+        std::memcpy(&f, &fbits, sizeof(f));
+        if (std::isfinite(f) && f != std::numeric_limits<float>::max()) check_halfway<float, unsigned>(f);
+    }
+    const std::string many = "1." + std::string(1000, '0') + "1";
+    CHECK(lite::parse_float<double>(lite::string_view(many.data(), many.size())).value == 1.0);
+    CHECK(lite::parse_float<double>(lite::string_view("179769313486231580793728971405303415079934132710037826936173778980444968292764750946649017977587207096330286416692887910946555547851940402630657488671505820681908902000708383676273854845817711531764475730270069855571366959622842914819860834936475292719074168444365510704342711559699508093042880177904174497792")).error == lite::parse_out_of_range);
+    CHECK(lite::parse_float<double>(lite::string_view("1e")).length == 1);
+    CHECK(lite::parse_float<double>(lite::string_view("1e309")).error == lite::parse_out_of_range);
+    CHECK(lite::parse_float<double>(lite::string_view("-Infinity")).value == -std::numeric_limits<double>::infinity());
+    CHECK(lite::parse_float<double>(lite::string_view("nan(0x1)")).length == 8);
+    CHECK(lite::parse_float<double>(lite::string_view(".")).error == lite::parse_invalid);
+
+    lite::string_view column[] = { "1.5", "-2", "abc" };
+    double out[3];
+    CHECK(lite::parse_float_batch(column, 3, out) == 1);
+    CHECK(out[1] == -2.0);
+}
+
+TEST_CASE("constexpr")
+{
+    using namespace lite::literals;
+
+    static_assert(std::is_trivially_copyable<lite::string_view>::value, "");
+    constexpr lite::string_view abc = "abcabc";
+    static_assert(abc.size() == 6, "");
+    static_assert("abc"_sv.size() == 3, "");
+    static_assert(abc.find("ca"_sv) == 2 && abc.rfind('b') == 4 && abc.find('z') == lite::string_view::_npos(), "");
+    static_assert(abc.find_first_of("cb"_sv) == 1 && abc.find_last_not_of("c"_sv) == 4, "");
+    static_assert(abc.starts_with("ab"_sv) && abc.ends_with("bc"_sv) && abc.contains("bca"_sv), "");
+    static_assert(abc.compare("abd"_sv) < 0 && "b"_sv > "abc"_sv && abc.substr(3) == "abc"_sv, "");
+    static_assert(u"ab"_sv.size() == 2 && U"ab"_sv.find(U'b') == 1 && L"ab"_sv.rfind(L"a"_sv) == 0, "");
+
+    // 編譯期與運行時的散列一致，包括不同長度的分支
+    constexpr lite::hash<lite::string_view> h;
+    constexpr std::size_t short_key = h("key"_sv);
+    constexpr std::size_t long_key = h("a key that is longer than forty-eight bytes in total!"_sv);
+    std::string s("key");
+    CHECK(short_key == h(lite::string_view(s.c_str())));
+    s = "a key that is longer than forty-eight bytes in total!";
+    CHECK(long_key == h(lite::string_view(s.data(), s.size())));
+    constexpr std::size_t wide = lite::hash<lite::basic_string_view<char16_t>>()(u"wide key"_sv);
+    std::u16string u(u"wide key");
+    CHECK(wide == lite::hash<lite::basic_string_view<char16_t>>()(lite::basic_string_view<char16_t>(u.data(), u.size())));
+
+    // 數組按第一個空字符截斷
+    char buffer[16] = "abc";
+    CHECK(lite::string_view(buffer).size() == 3);
+    const char raw[3] = { 'x', 'y', 'z' };
+    CHECK(lite::string_view(raw).size() == 3);
+}
+
+TEST_CASE("static_map")
+{
+    constexpr auto methods = lite::make_static_map<int>({ { "GET", 1 }, { "POST", 2 }, { "PUT", 3 }, { "DELETE", 4 }, { "HEAD", 5 } });
+    static_assert(methods.size() == 5 && methods.at("PUT") == 3 && !methods.contains("get"), "");
+    CHECK(methods.get(lite::string_view(std::string("DELETE").c_str()), 0) == 4);
+    CHECK(methods.find("PATCH") == NULLPTR);
+    CHECK(methods.key(0) == lite::string_view("GET") && methods.value(0) == 1);
+
+    // 隨機生成的鍵在運行時構造，每個鍵都要找到自己的位置
+    std::vector<std::string> storage;
+    for (int i = 0; i < 300; ++i)
+    {
+        storage.push_back("keyword_" + std::to_string(i * 7919 % 1000));
+    }
+    lite::string_view keys[300];
+    for (int i = 0; i < 300; ++i)
+    {
+        keys[i] = lite::string_view(storage[i].data(), storage[i].size());
+    }
+    lite::static_map<std::size_t, 300> many(keys);
+    for (std::size_t i = 0; i < 300; ++i)
+    {
+        CHECK(many.index_of(keys[i]) == i);
+    }
+    CHECK(many.index_of("keyword_") == many._npos());
+    CHECK(many.index_of("") == many._npos());
+
+    const lite::string_view twice[] = { "a", "b", "a" };
+    CHECK_THROWS_AS(lite::make_static_keys(twice), std::invalid_argument);
+
+    constexpr auto verbs = lite::make_static_keys({ "start", "stop" });
+    auto run = [&](lite::string_view v)
+    {
+        return lite::static_switch(verbs, v, [] { return 1; }, [] { return 2; }, [] { return 0; });
+    };
+    CHECK(run("start") == 1);
+    CHECK(run("stop") == 2);
+    CHECK(run("pause") == 0);
+
+    // 只調用選中的一個處理函數，可以是有狀態的lambda，返回void
+    int calls[4] = { 0, 0, 0, 0 };
+    constexpr auto seasons = lite::make_static_keys({ "spring", "summer", "autumn" });
+    for (lite::string_view s : { "autumn", "winter", "spring", "autumn" })
+    {
+        lite::static_switch(seasons, s,
+                            [&] { ++calls[0]; }, [&] { ++calls[1]; }, [&] { ++calls[2]; }, [&] { ++calls[3]; });
+    }
+    CHECK(calls[0] == 1);
+    CHECK(calls[1] == 0);
+    CHECK(calls[2] == 2);
+    CHECK(calls[3] == 1);
+}
+
+TEST_CASE("ci_string_view")
+{
+    lite::ci_string_view header("Content-Type");
+    CHECK(header == lite::ci_string_view("content-type"));
+    CHECK(header.compare("CONTENT-TYPF") < 0);
+    CHECK(header.find("TYPE") == 8);
+    CHECK(header.find('t') == 3);
+    CHECK(header.rfind('T') == 8);
+    CHECK(header.find_first_of("YP") == 9);
+    CHECK(header.starts_with("content"));
+    static_assert(lite::ci_string_view("ABC") == lite::ci_string_view("abc"), "");
+
+    CHECK(lite::iequals("Accept-Encoding", "ACCEPT-ENCODING"));
+    CHECK(!lite::iequals("Accept", "Accept-"));
+    CHECK(!lite::iequals("[", "{")); // 不是字母，大小寫位不同也不相等
+    CHECK(lite::istarts_with("Transfer-Encoding: chunked", "transfer-"));
+    CHECK(lite::iends_with("image/PNG", "png"));
+
+    // 與先轉小寫再查找的結果一致，覆蓋SIMD塊和尾部
+    std::string text;
+    for (int i = 0; i < 500; ++i)
+    {
+        text += static_cast<char>("aBcDxYz-_ \xc3\xa9"[i * 7 % 13]);
+    }
+    std::string lower(text.size(), '\0');
+    lite::ascii::to_lower(text.data(), text.size(), &lower[0]);
+    std::string upper(text.size(), '\0');
+    lite::ascii::to_upper(text.data(), text.size(), &upper[0]);
+    for (std::size_t i = 0; i < text.size(); ++i)
+    {
+        CHECK(lower[i] == static_cast<char>(text[i] >= 'A' && text[i] <= 'Z' ? text[i] + 32 : text[i]));
+        CHECK(upper[i] == static_cast<char>(text[i] >= 'a' && text[i] <= 'z' ? text[i] - 32 : text[i]));
+    }
+    lite::string_view t(text.data(), text.size());
+    for (std::size_t m = 1; m <= 40; m += 3)
+    {
+        for (std::size_t at = 0; at + m <= text.size(); at += 37)
+        {
+            std::string needle = upper.substr(at, m);
+            CHECK(lite::ifind(t, lite::string_view(needle.data(), needle.size())) == std::string_view(lower).find(lower.substr(at, m)));
+            CHECK(lite::ifind(t, lite::string_view(needle.data(), needle.size()), at + 1) == std::string_view(lower).find(lower.substr(at, m), at + 1));
+        }
+    }
+    CHECK(lite::ifind(t, "QQ") == lite::string_view::_npos());
+    char buffer[8];
+    CHECK(lite::ascii::to_upper(lite::string_view("gzip"), buffer) == lite::string_view("GZIP"));
+
+    // searcher和split用ci_char_traits的string_search
+    const lite::ci_string_view fields("Accept AND Content-Type and HOST");
+    const lite::searcher<char, lite::ci_char_traits> and_searcher(lite::ci_string_view(" and "));
+    CHECK(and_searcher.find(fields) == 6);
+    CHECK(and_searcher.count(fields) == 2);
+    const lite::searcher<char, lite::ci_char_traits> h_searcher(lite::ci_string_view("h"));
+    CHECK(h_searcher.find(fields) == 28);
+    typedef std::vector<lite::ci_string_view> ci_tokens;
+    auto parts = lite::split(fields, lite::ci_string_view(" AND "));
+    CHECK(ci_tokens(parts.begin(), parts.end()) == ci_tokens{"accept", "content-type", "host"});
+    CHECK(lite::parallel::count(fields, " AND ") == 2);
+}
+
+TEST_CASE("utf8")
+{
+    const char text[] = "a\xc3\xa9\xe2\x82\xac\xf0\x9f\x98\x80z"; // a é € 😀 z
+    lite::string_view s(text);
+    CHECK(lite::utf8::validate(s));
+    CHECK(lite::utf8::count(s) == 5);
+
+    std::vector<lite::utf8::code_point> cps;
+    for (lite::utf8::code_point c : lite::utf8::code_points(s)) cps.push_back(c);
+    CHECK(cps == std::vector<lite::utf8::code_point>{ U'a', U'é', U'€', U'\U0001F600', U'z' });
+
+    CHECK(lite::utf8::truncate(s, 100) == s);
+    CHECK(lite::utf8::truncate(s, 2) == lite::string_view("a"));
+    CHECK(lite::utf8::truncate(s, 3) == lite::string_view("a\xc3\xa9"));
+    CHECK(lite::utf8::truncate(s, 9) == lite::string_view("a\xc3\xa9\xe2\x82\xac"));
+    CHECK(lite::utf8::truncate(s, 0).empty());
+
+    char16_t buffer[sizeof(text)];
+    CHECK(lite::utf8::to_utf16(s, buffer) == lite::basic_string_view<char16_t>(u"aé€\U0001F600z"));
+
+    // 過長編碼、代理、超過U+10FFFF、截斷、孤立的後續字節
+    const char* invalid[] = { "\xc0\xaf", "\xc1\xbf", "\xe0\x80\xaf", "\xe0\x9f\xbf", "\xed\xa0\x80", "\xf0\x80\x80\xaf",
+                              "\xf0\x8f\xbf\xbf", "\xf4\x90\x80\x80", "\xf5\x80\x80\x80", "\xff", "\x80", "\xc3", "\xe2\x82", "\xf0\x9f\x98",
+                              "\xe2\x28\xa1", "\xc3\xa9\xa9" };
+    for (const char* bad : invalid)
+    {
+        CHECK(!lite::utf8::validate(bad));
+        CHECK(lite::utf8::valid_prefix(bad) < std::strlen(bad));
+    }
+    CHECK(lite::utf8::validate("\xed\x9f\xbf\xee\x80\x80\xf4\x8f\xbf\xbf\xf0\x90\x80\x80"));
+
+    // 所有碼位編碼後再解碼、轉UTF-16
+    std::string all;
+    std::u16string expected;
+    for (char32_t c = 0; c <= 0x10FFFF; c += (c < 0x800 ? 1 : 7))
+    {
+        if (c >= 0xD800 && c <= 0xDFFF) continue;
+        if (c < 0x80) all += static_cast<char>(c);
+        else if (c < 0x800) all += { static_cast<char>(0xC0 | (c >> 6)), static_cast<char>(0x80 | (c & 0x3F)) };
+        else if (c < 0x10000) all += { static_cast<char>(0xE0 | (c >> 12)), static_cast<char>(0x80 | ((c >> 6) & 0x3F)), static_cast<char>(0x80 | (c & 0x3F)) };
+        else all += { static_cast<char>(0xF0 | (c >> 18)), static_cast<char>(0x80 | ((c >> 12) & 0x3F)), static_cast<char>(0x80 | ((c >> 6) & 0x3F)), static_cast<char>(0x80 | (c & 0x3F)) };
+        if (c < 0x10000) expected += static_cast<char16_t>(c);
+        else expected += { static_cast<char16_t>(0xD800 + ((c - 0x10000) >> 10)), static_cast<char16_t>(0xDC00 + ((c - 0x10000) & 0x3FF)) };
+    }
+    lite::string_view a(all.data(), all.size());
+    CHECK(lite::utf8::validate(a));
+    std::vector<char16_t> out(all.size());
+    CHECK(lite::utf8::to_utf16(a, out.data()) == lite::basic_string_view<char16_t>(expected.data(), expected.size()));
+    std::size_t n = 0;
+    for (lite::utf8::code_point c : lite::utf8::code_points(a)) n += c != lite::utf8::replacement;
+    CHECK(n == lite::utf8::count(a));
+
+    // 向量化驗證與逐個解碼的結果一致，錯誤放在塊內和跨塊的各個位置
+    std::string mixed;
+    for (int i = 0; i < 300; ++i) mixed += i % 5 == 0 ? "\xe2\x82\xac" : i % 7 == 0 ? "\xf0\x9f\x98\x80" : "ab";
+    for (std::size_t len = 0; len <= 100; ++len)
+    {
+        for (std::size_t at = 0; at < len; at += 5)
+        {
+            for (const char* bad : invalid)
+            {
+                std::string t = mixed.substr(0, len);
+                t.replace(at, std::min(std::strlen(bad), len - at), bad);
+                lite::string_view v(t.data(), t.size());
+                CHECK(lite::utf8::validate(v) == (lite::utf8::valid_prefix(v) == v.size()));
+            }
+        }
+        lite::string_view v(mixed.data(), len);
+        CHECK(lite::utf8::validate(v) == (lite::utf8::valid_prefix(v) == v.size()));
+        CHECK(lite::utf8::validate(lite::utf8::truncate(v, len / 2)));
+    }
+
+    // 長段ASCII按16字節跳過，錯誤字節在段內各個位置都能停下
+    for (std::size_t at = 0; at < 70; ++at)
+    {
+        std::string t(70, 'x');
+        t[at] = '\x80';
+        CHECK(lite::utf8::valid_prefix(lite::string_view(t.data(), t.size())) == at);
+        CHECK(!lite::utf8::validate(lite::string_view(t.data(), t.size())));
+    }
+}
+
+// 寬字符的各個成員與std::basic_string_view的結果一致，字符取值跨過256和代理區
+template <typename CharT>
+void check_wide()
+{
+    typedef lite::basic_string_view<CharT> lite_view;
+    typedef std::basic_string_view<CharT> std_view;
+
+    const CharT alphabet[] = { 'a', 'b', ',', ' ', 0xE9, 0x4E2D, 0xD83D, 0xDE00, 0xFF, 0x100 };
+    std::vector<CharT> text;
+    for (std::size_t i = 0; i < 700; ++i)
+    {
+        text.push_back(alphabet[i * i % 7 + (i % 11 == 0 ? 3 : 0)]);
+    }
+    const CharT* sets[] = { alphabet + 2, alphabet + 5, alphabet + 4 };
+    const std::size_t set_sizes[] = { 1, 3, 6 };
+    std::vector<CharT> big_set(alphabet + 1, alphabet + 10); // 超過16個字符時走位圖
+    for (CharT c = 'A'; c <= 'Z'; ++c) big_set.push_back(c);
+
+    for (std::size_t n = 0; n <= text.size(); n += n < 80 ? 1 : 97)
+    {
+        lite_view l(text.data(), n);
+        std_view s(text.data(), n);
+        for (std::size_t k = 0; k < 3; ++k)
+        {
+            lite_view ls(sets[k], set_sizes[k]);
+            std_view ss(sets[k], set_sizes[k]);
+            CHECK(l.find_first_of(ls) == s.find_first_of(ss));
+            CHECK(l.find_last_of(ls) == s.find_last_of(ss));
+            CHECK(l.find_first_not_of(ls) == s.find_first_not_of(ss));
+            CHECK(l.find_last_not_of(ls) == s.find_last_not_of(ss));
+            CHECK(l.find_first_of(ls, n / 3) == s.find_first_of(ss, n / 3));
+            CHECK(l.find_last_of(ls, n / 2) == s.find_last_of(ss, n / 2));
+        }
+        CHECK(l.find_first_of(lite_view(big_set.data(), big_set.size())) == s.find_first_of(std_view(big_set.data(), big_set.size())));
+        CHECK(l.find_last_not_of(lite_view(big_set.data(), 20)) == s.find_last_not_of(std_view(big_set.data(), 20)));
+
+        CHECK(l.find(CharT(0x4E2D)) == s.find(CharT(0x4E2D)));
+        CHECK(l.rfind(CharT(0xFF)) == s.rfind(CharT(0xFF)));
+        if (n >= 40)
+        {
+            for (std::size_t m = 2; m <= 40; m += 7)
+            {
+                lite_view needle(text.data() + n - m, m);
+                CHECK(l.find(needle) == s.find(std_view(needle.data(), m)));
+                CHECK(l.rfind(needle, n / 2) == s.rfind(std_view(needle.data(), m), n / 2));
+            }
+        }
+
+        // 在每個位置改一個字符後比較
+        for (std::size_t at = 0; at < n; at += 1 + n / 8)
+        {
+            std::vector<CharT> other(text.begin(), text.begin() + n);
+            other[at] = CharT(other[at] + (at % 2 ? 1 : -1));
+            lite_view o(other.data(), n);
+            std_view so(other.data(), n);
+            CHECK((l.compare(o) < 0) == (s.compare(so) < 0));
+            CHECK((l.compare(o) > 0) == (s.compare(so) > 0));
+            CHECK(l != o);
+            CHECK(lite::mismatch(l, o) == at);
+        }
+        CHECK(l.compare(lite_view(text.data(), n)) == 0);
+        CHECK(lite::hash<lite_view>()(l) == lite::hash<lite_view>()(lite_view(std::vector<CharT>(text.begin(), text.begin() + n).data(), n)));
+    }
+}
+
+TEST_CASE("wide")
+{
+    check_wide<wchar_t>();
+    check_wide<char16_t>();
+    check_wide<char32_t>();
+
+    using namespace lite::literals;
+    lite::u16string_view s = u"中文, text"_sv;
+    CHECK(s.find(u"text") == 4);
+    CHECK(s.find_first_of(u", ") == 2);
+    CHECK(s.compare(u"中文, texu") < 0);
+    CHECK(s.compare(u"中") > 0);
+    CHECK((std::is_same<decltype(U"x"_sv), const lite::u32string_view>::value || std::is_same<decltype(U"x"_sv), lite::u32string_view>::value));
+    lite::wstring_view w = L"path\\to\\file";
+    CHECK(w.find_last_of(L"\\/") == 7);
+    CHECK(lite::hash<lite::u16string_view>()(s) != lite::hash<lite::u16string_view>()(s.substr(1)));
+}
+
+TEST_CASE("stats")
+{
+    typedef lite::stats::family family;
+    lite::stats::reset();
+
+    std::string text(100, 'a');
+    text[60] = 'b';
+    lite::string_view sv(text.c_str(), text.size());
+    sv.find('b');
+    sv.find("ab");
+    sv.find('c', 10);
+    sv.rfind('b');
+    sv.find_first_of("xb");
+    sv.compare(lite::string_view("aaa"));
+    CHECK(sv == sv);
+    char buf[8];
+    sv.copy(buf, sizeof(buf));
+
+    std::thread worker([] { lite::string_view("xyz").find('z'); });
+    worker.join();
+
+    const lite::stats::report r = lite::stats::snapshot();
+    const std::string json = lite::stats::dump(lite::stats::format::json);
+    CHECK(json.find("\"find_last_not_of\"") != std::string::npos);
+#if LITE_STATS
+    CHECK(r[family::find].calls == 4);
+    CHECK(r[family::find].matches == 3);
+    CHECK(r[family::find].bytes == 61 + 61 + 90 + 3);
+    CHECK(r[family::find].haystack[lite::stats::bucket(100)] == 3);
+    CHECK(r[family::find].haystack[lite::stats::bucket(3)] == 1);
+    CHECK(r[family::find].needle[lite::stats::bucket(2)] == 1);
+    CHECK(r[family::rfind].calls == 1);
+    CHECK(r[family::rfind].bytes == 40);
+    CHECK(r[family::find_first_of].calls == 1);
+    CHECK(r[family::compare].calls == 2);
+    CHECK(r[family::compare].matches == 1);
+    CHECK(r[family::copy].bytes == 8);
+    CHECK(r[family::find_last_of].calls == 0);
+    CHECK(json.find("\"enabled\": true") != std::string::npos);
+    CHECK(lite::stats::dump().find("calls 4  bytes 215") != std::string::npos);
+
+    lite::stats::reset();
+    CHECK(lite::stats::snapshot()[family::find].calls == 0);
+#else
+    CHECK(r[family::find].calls == 0);
+    CHECK(json.find("\"enabled\": false") != std::string::npos);
+#endif
+    CHECK(lite::stats::bucket(0) == 0);
+    CHECK(lite::stats::bucket(1) == 1);
+    CHECK(lite::stats::bucket(7) == 3);
+    CHECK(lite::stats::bucket(8) == 4);
+}
+
+TEST_CASE("parallel")
+{
+    // 塊很小，匹配經常跨過塊的邊界
+    lite::parallel::thread_pool pool(4);
+    lite::parallel::options o;
+    o.pool = &pool;
+    o.chunk_bytes = 64;
+
+    std::string text;
+    for (int i = 0; i < 5000; ++i)
+    {
+        text += static_cast<char>('a' + (i * 7 + i / 13) % 5);
+    }
+    const lite::string_view sv(text.c_str(), text.size());
+    const char* needles[] = { "a", "ab", "cad", "eabcdeab", "zz" };
+    for (std::size_t i = 0; i < sizeof(needles) / sizeof(needles[0]); ++i)
+    {
+        const lite::string_view needle(needles[i]);
+        const lite::searcher<char> s(needle);
+        CHECK(lite::parallel::find(sv, needle, 0, o) == sv.find(needle));
+        CHECK(lite::parallel::find(sv, needle, 1234, o) == sv.find(needle, 1234));
+        CHECK(lite::parallel::count(sv, needle, o) == s.count(sv));
+        std::vector<std::size_t> expected;
+        std::vector<std::size_t> actual;
+        s.find_all(sv, std::back_inserter(expected));
+        lite::parallel::find_all(sv, needle, std::back_inserter(actual), o);
+        CHECK(actual == expected);
+    }
+    CHECK(lite::parallel::find(sv, text.substr(4000, 300).c_str(), 0, o) == sv.find(lite::string_view(text.c_str() + 4000, 300)));
+    CHECK(lite::parallel::find(sv, 'e', 77, o) == sv.find('e', 77));
+    CHECK(lite::parallel::find(sv, "", 5000, o) == 5000);
+    CHECK(lite::parallel::find(sv, "ab", 5001, o) == std::string::npos);
+
+    // 自重疊的模式串：從不同起點貪心得到的不重疊匹配不同，拼接時要重新對齊
+    const std::string periodic(1001, 'a');
+    const lite::string_view pv(periodic.c_str(), periodic.size());
+    const char* overlapping[] = { "aa", "aaa", "aaaaaaa" };
+    for (std::size_t i = 0; i < sizeof(overlapping) / sizeof(overlapping[0]); ++i)
+    {
+        const lite::string_view needle(overlapping[i]);
+        CHECK(lite::parallel::count(pv, needle, o) == periodic.size() / needle.size());
+        std::vector<std::size_t> positions;
+        lite::parallel::find_all(pv, needle, std::back_inserter(positions), o);
+        CHECK(positions.size() == periodic.size() / needle.size());
+        CHECK(positions.back() == (positions.size() - 1) * needle.size());
+    }
+    std::string abab;
+    for (int i = 0; i < 700; ++i) abab += i % 50 == 49 ? "b" : "ab";
+    const lite::string_view av(abab.c_str(), abab.size());
+    CHECK(lite::parallel::count(av, "abab", o) == lite::searcher<char>(lite::string_view("abab")).count(av));
+    CHECK(lite::parallel::count(av, "", o) == abab.size() + 1);
+
+    for (std::size_t pos = 0; pos < text.size(); pos += 997)
+    {
+        CHECK(lite::parallel::find_first_of(sv, "de", pos, o) == sv.find_first_of("de", pos));
+        CHECK(lite::parallel::find_first_not_of(sv, "abcd", pos, o) == sv.find_first_not_of("abcd", pos));
+        CHECK(lite::parallel::find_last_of(sv, "b", pos, o) == sv.find_last_of("b", pos));
+        CHECK(lite::parallel::find_last_not_of(sv, "bcde", pos, o) == sv.find_last_not_of("bcde", pos));
+    }
+    CHECK(lite::parallel::find_first_of(sv, "xyz", 0, o) == std::string::npos);
+    CHECK(lite::parallel::find_last_of(sv, "xyz", std::string::npos, o) == std::string::npos);
+    CHECK(lite::parallel::find_last_of(sv, "b", std::string::npos, o) == sv.find_last_of('b'));
+
+    const std::u16string wide(3000, u'x');
+    const lite::u16string_view wv(wide.c_str(), wide.size());
+    CHECK(lite::parallel::find(wv, u'y', 0, o) == std::string::npos);
+    CHECK(lite::parallel::count(wv, u"xxx", o) == 1000);
+
+    // 任務拋出的異常傳回調用者，線程池之後還能用
+    bool thrown = false;
+    try
+    {
+        pool.for_each_index(100, [](std::size_t i) { if (i == 42) throw std::runtime_error("42"); });
+    }
+    catch (const std::runtime_error&)
+    {
+        thrown = true;
+    }
+    CHECK(thrown);
+    std::atomic<std::size_t> sum(0);
+    pool.for_each_index(100, [&](std::size_t i) { sum += i; });
+    CHECK(sum == 4950);
+}
+
 TEST_CASE("operator=")
 {
     string_view_t sv1("123");
@@ -290,6 +1563,41 @@ TEST_CASE("operator== != < <= > >=")
     CHECK((sv2 >= sv1));
 }
 
+TEST_CASE("mismatch")
+{
+    std::string a(300, 'x');
+    for (std::size_t i = 0; i < a.size(); ++i)
+    {
+        a[i] = static_cast<char>('a' + i * 7 % 26);
+    }
+    for (std::size_t n = 0; n <= 70; ++n)
+    {
+        for (std::size_t k = 0; k <= n; ++k)
+        {
+            std::string b = a.substr(0, n);
+            if (k < n) b[k] = '#';
+            lite::string_view x(a.data(), n);
+            lite::string_view y(b.data(), b.size());
+            CHECK(lite::mismatch(x, y) == k);
+            CHECK((x == y) == (k == n));
+            CHECK(x.compare(y) == (k == n ? 0 : (a[k] < '#' ? -1 : 1)));
+        }
+        CHECK(lite::mismatch(lite::string_view(a.data(), n), lite::string_view(a.data(), a.size())) == n);
+        CHECK(lite::string_view(a.data(), n) != lite::string_view(a.data(), n + 1));
+    }
+
+    std::u32string w(U"abcdefghijklmnopq");
+    std::u32string v(w);
+    v[13] = U'\x1f600';
+    CHECK(lite::mismatch(lite::basic_string_view<char32_t>(w.data(), w.size()), lite::basic_string_view<char32_t>(v.data(), v.size())) == 13);
+    static_assert(lite::mismatch(lite::string_view("prefix-a"), lite::string_view("prefix-b")) == 7, "");
+
+    CHECK((lite::string_view("abc") <=> lite::string_view("abd")) == std::strong_ordering::less);
+    CHECK((lite::string_view("abc") <=> lite::string_view("abc")) == std::strong_ordering::equal);
+    CHECK((lite::string_view("abcd") <=> lite::string_view("abc")) == std::strong_ordering::greater);
+    static_assert(std::is_same_v<decltype(lite::string_view() <=> lite::string_view()), std::strong_ordering>);
+}
+
 template<typename InputIt, typename UnaryPredicate>
 CONSTEXPR InputIt find_last_if(InputIt first, InputIt last, UnaryPredicate p)
 {
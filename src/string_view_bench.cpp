@@ -0,0 +1,470 @@
+#include "bench_suite.hpp"
+#include <lite/string_view.hpp>
+#include <lite/hash.hpp>
+#include <lite/ci_string_view.hpp>
+#include <lite/parse.hpp>
+#include <lite/utf8.hpp>
+#include <lite/parallel.hpp>
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace
+{
+    volatile std::size_t sink = 0;
+
+    template<typename F>
+    double gb_per_s(std::size_t bytes, F f)
+    {
+        typedef std::chrono::steady_clock clock;
+        std::size_t iterations = 1;
+        for (;;)
+        {
+            clock::time_point start = clock::now();
+            for (std::size_t i = 0; i < iterations; ++i)
+            {
+                sink = sink + f();
+            }
+            double seconds = std::chrono::duration<double>(clock::now() - start).count();
+            if (seconds > 0.2)
+            {
+                return static_cast<double>(bytes) * iterations / seconds / 1e9;
+            }
+            iterations *= 2;
+        }
+    }
+
+    void find_char(std::size_t size)
+    {
+        std::string haystack(size, 'a');
+        haystack[size - 1] = 'b';
+
+        lite::string_view lsv(haystack.data(), haystack.size());
+        std::string_view ssv(haystack.data(), haystack.size());
+        const char* p = haystack.data();
+
+        double lite_find = gb_per_s(size, [&] { return lsv.find('b'); });
+        double std_find = gb_per_s(size, [&] { return ssv.find('b'); });
+        double memchr_find = gb_per_s(size, [&] {
+            return static_cast<std::size_t>(static_cast<const char*>(std::memchr(p, 'b', size)) - p);
+        });
+
+        haystack[size - 1] = 'a';
+        haystack[0] = 'b';
+        double lite_rfind = gb_per_s(size, [&] { return lsv.rfind('b'); });
+        double std_rfind = gb_per_s(size, [&] { return ssv.rfind('b'); });
+
+        std::printf("%10zu %12.2f %12.2f %12.2f %12.2f %12.2f\n",
+            size, lite_find, std_find, memchr_find, lite_rfind, std_rfind);
+    }
+
+    void find_substring(std::size_t size, std::size_t needle_size)
+    {
+        std::string haystack(size, 'a');
+        unsigned seed = 1;
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            seed = seed * 1103515245u + 12345u;
+            haystack[i] = static_cast<char>('a' + (seed >> 16) % 26);
+        }
+        std::string needle = haystack.substr(size / 2, needle_size);
+        needle[needle_size / 2] = '#';
+
+        lite::string_view lsv(haystack.data(), haystack.size());
+        std::string_view ssv(haystack.data(), haystack.size());
+        lite::string_view lneedle(needle.data(), needle.size());
+        std::string_view sneedle(needle.data(), needle.size());
+
+        double lite_find = gb_per_s(size, [&] { return lsv.find(lneedle); });
+        double std_find = gb_per_s(size, [&] { return ssv.find(sneedle); });
+        double lite_rfind = gb_per_s(size, [&] { return lsv.rfind(lneedle); });
+        double std_rfind = gb_per_s(size, [&] { return ssv.rfind(sneedle); });
+
+        std::printf("%10zu %8zu %12.2f %12.2f %12.2f %12.2f\n",
+            size, needle_size, lite_find, std_find, lite_rfind, std_rfind);
+    }
+
+    void find_first_of(std::size_t size)
+    {
+        std::string haystack(size, 'a');
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            haystack[i] = static_cast<char>('a' + i % 26);
+        }
+        haystack[size - 1] = ';';
+        const char* delims = ",;\t\n|";
+
+        lite::string_view lsv(haystack.data(), haystack.size());
+        std::string_view ssv(haystack.data(), haystack.size());
+        lite::char_set set(delims);
+
+        double lite_view = gb_per_s(size, [&] { return lsv.find_first_of(delims); });
+        double lite_set = gb_per_s(size, [&] { return lsv.find_first_of(set); });
+        double std_view = gb_per_s(size, [&] { return ssv.find_first_of(delims); });
+
+        std::printf("%10zu %12.2f %12.2f %12.2f\n", size, lite_view, lite_set, std_view);
+    }
+
+    void hash_keys(std::size_t key_size)
+    {
+        const std::size_t count = 1024;
+        std::string keys(key_size * count, 'a');
+        for (std::size_t i = 0; i < keys.size(); ++i)
+        {
+            keys[i] = static_cast<char>('a' + (i * 31 + i / 7) % 26);
+        }
+
+        lite::hash<lite::string_view> lite_hash;
+        std::hash<std::string_view> std_hash;
+        const char* p = keys.data();
+
+        double lite_gbs = gb_per_s(keys.size(), [&] {
+            std::size_t h = 0;
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                h ^= lite_hash(lite::string_view(p + i * key_size, key_size));
+            }
+            return h;
+        });
+        double std_gbs = gb_per_s(keys.size(), [&] {
+            std::size_t h = 0;
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                h ^= std_hash(std::string_view(p + i * key_size, key_size));
+            }
+            return h;
+        });
+
+        std::printf("%10zu %12.2f %12.2f\n", key_size, lite_gbs, std_gbs);
+    }
+
+    // 去重時的相等比較：一半鍵相同，另一半最後一個字符不同
+    void equal_keys(std::size_t key_size)
+    {
+        const std::size_t count = 1024;
+        std::string keys(key_size * count, 'a');
+        for (std::size_t i = 0; i < keys.size(); ++i)
+        {
+            keys[i] = static_cast<char>('a' + (i * 31 + i / 7) % 26);
+        }
+        std::string other = keys;
+        for (std::size_t i = 1; i < count; i += 2)
+        {
+            other[i * key_size + key_size - 1] = '#';
+        }
+        const char* p = keys.data();
+        const char* q = other.data();
+
+        double lite_gbs = gb_per_s(keys.size(), [&] {
+            std::size_t n = 0;
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                n += lite::string_view(p + i * key_size, key_size) == lite::string_view(q + i * key_size, key_size);
+            }
+            return n;
+        });
+        double std_gbs = gb_per_s(keys.size(), [&] {
+            std::size_t n = 0;
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                n += std::string_view(p + i * key_size, key_size) == std::string_view(q + i * key_size, key_size);
+            }
+            return n;
+        });
+
+        std::printf("%10zu %12.2f %12.2f\n", key_size, lite_gbs, std_gbs);
+    }
+
+    // 忽略大小寫查找：ifind對比先用tolower複製一份再查找
+    void ifind_text(std::size_t size)
+    {
+        std::string haystack(size, 'a');
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            haystack[i] = static_cast<char>((i % 3 ? 'a' : 'A') + i * 7 % 26);
+        }
+        haystack.replace(size - 12, 12, "Content-Type");
+        lite::string_view lsv(haystack.data(), haystack.size());
+        std::string lowered(size, '\0');
+
+        double lite_gbs = gb_per_s(size, [&] { return lite::ifind(lsv, "CONTENT-TYPE"); });
+        double simd_copy_gbs = gb_per_s(size, [&] {
+            lite::ascii::to_lower(haystack.data(), size, &lowered[0]);
+            return std::string_view(lowered).find("content-type");
+        });
+        double tolower_gbs = gb_per_s(size, [&] {
+            std::transform(haystack.begin(), haystack.end(), lowered.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+            return std::string_view(lowered).find("content-type");
+        });
+
+        std::printf("%10zu %12.2f %12.2f %12.2f\n", size, lite_gbs, simd_copy_gbs, tolower_gbs);
+    }
+
+    // 標準算法經過begin()/end()、舊的LegacyRandomAccessIterator和裸指針的速度（GB/s）。
+    // begin()/end()是連續迭代器時應與裸指針相同
+    template <typename F>
+    void iterator_algorithm(const char* name, std::size_t size, F f)
+    {
+        typedef LegacyRandomAccessIterator<lite::basic_string_view_const_iterator<char> > legacy;
+        std::string text(size, 'a');
+        text[size - 1] = 'b';
+        std::string copy(text);
+        lite::string_view lsv(text.data(), size);
+        const char* p = text.data();
+        char* q = &copy[0];
+
+        double view_gbs = gb_per_s(size, [&] { return f(lsv.begin(), lsv.end(), q); });
+        double legacy_gbs = gb_per_s(size, [&] { return f(legacy(const_cast<char*>(p)), legacy(const_cast<char*>(p + size)), q); });
+        double raw_gbs = gb_per_s(size, [&] { return f(p, p + size, q); });
+
+        std::printf("%10zu %8s %12.2f %12.2f %12.2f\n", size, name, view_gbs, legacy_gbs, raw_gbs);
+    }
+
+    void iterator_algorithms(std::size_t size)
+    {
+        iterator_algorithm("find", size, [](auto first, auto last, char*) {
+            return static_cast<std::size_t>(std::find(first, last, 'b') - first);
+        });
+        iterator_algorithm("count", size, [](auto first, auto last, char*) {
+            return static_cast<std::size_t>(std::count(first, last, 'b'));
+        });
+        iterator_algorithm("equal", size, [](auto first, auto last, char* out) {
+            return static_cast<std::size_t>(std::equal(first, last, static_cast<const char*>(out)));
+        });
+        iterator_algorithm("copy", size, [](auto first, auto last, char* out) {
+            return static_cast<std::size_t>(std::copy(first, last, out) - out);
+        });
+    }
+
+    // 寬字符：每列是lite/std的GB/s。查找的目標都在末尾，比較的兩個視圖只有最後一個字符不同
+    template <typename CharT>
+    void wide_members(const char* name, std::size_t size)
+    {
+        const std::size_t n = size / sizeof(CharT);
+        std::vector<CharT> text(n, CharT(0x4E00));
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            text[i] = static_cast<CharT>(0x4E00 + i * 7 % 64);
+        }
+        text[n - 1] = CharT(',');
+        std::vector<CharT> other(text);
+        other[n - 1] = CharT(';');
+        const CharT delims[] = { CharT(','), CharT(' '), CharT('\t'), CharT(';') };
+
+        // 模式串是末尾的6個字符，前面按64個字符循環，只在末尾匹配
+        const CharT* needle = text.data() + n - 6;
+        lite::basic_string_view<CharT> l(text.data(), n), lo(other.data(), n), ln(needle, 6), ld(delims, 4);
+        std::basic_string_view<CharT> s(text.data(), n), so(other.data(), n), sn(needle, 6), sd(delims, 4);
+        lite::hash<lite::basic_string_view<CharT> > lite_hash;
+        std::hash<std::basic_string_view<CharT> > std_hash;
+
+        std::printf("%10zu %8s", size, name);
+        std::printf(" %6.2f/%-6.2f", gb_per_s(size, [&] { return l.find(CharT(',')); }), gb_per_s(size, [&] { return s.find(CharT(',')); }));
+        std::printf(" %6.2f/%-6.2f", gb_per_s(size, [&] { return l.find(ln); }), gb_per_s(size, [&] { return s.find(sn); }));
+        std::printf(" %6.2f/%-6.2f", gb_per_s(size, [&] { return static_cast<std::size_t>(l.compare(lo)); }),
+                    gb_per_s(size, [&] { return static_cast<std::size_t>(s.compare(so)); }));
+        std::printf(" %6.2f/%-6.2f", gb_per_s(size, [&] { return l.find_first_of(ld); }), gb_per_s(size, [&] { return s.find_first_of(sd); }));
+        std::printf(" %6.2f/%-6.2f\n", gb_per_s(size, [&] { return lite_hash(l); }), gb_per_s(size, [&] { return std_hash(s); }));
+    }
+
+    // ascii爲真時全是ASCII，否則大部分是三字節的漢字，夾雜ASCII和四字節序列
+    void utf8_text(std::size_t size, bool ascii)
+    {
+        std::string text;
+        for (std::size_t i = 0; text.size() < size; ++i)
+        {
+            text += ascii || i % 5 == 0 ? "text " : i % 17 == 0 ? "\xf0\x9f\x98\x80" : "\xe4\xb8\xad\xe6\x96\x87";
+        }
+        lite::string_view lsv = lite::utf8::truncate(lite::string_view(text.data(), text.size()), size);
+        std::vector<lite::utf8::utf16_unit> out(lsv.size());
+
+        double validate_gbs = gb_per_s(lsv.size(), [&] { return lite::utf8::validate(lsv); });
+        double scalar_gbs = gb_per_s(lsv.size(), [&] { return lite::utf8::valid_prefix(lsv); });
+        double count_gbs = gb_per_s(lsv.size(), [&] { return lite::utf8::count(lsv); });
+        double utf16_gbs = gb_per_s(lsv.size(), [&] { return lite::utf8::to_utf16(lsv, out.data()).size(); });
+
+        std::printf("%10zu %6s %12.2f %12.2f %12.2f %12.2f\n", size, ascii ? "ascii" : "cjk", validate_gbs, scalar_gbs, count_gbs, utf16_gbs);
+    }
+
+    // 每秒解析的數值個數（百萬）
+    template <typename T>
+    void parse_numbers(const char* name, const char* format, double scale)
+    {
+        const std::size_t count = 4096;
+        std::vector<std::string> text(count);
+        unsigned long long x = 88172645463325252ull;
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            x ^= x << 13;
+            x ^= x >> 7;
+            x ^= x << 17;
+            char buffer[64];
+            std::snprintf(buffer, sizeof(buffer), format, static_cast<T>(static_cast<double>(x % 1000000007ull) * scale));
+            text[i] = buffer;
+        }
+        std::vector<lite::string_view> fields;
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            fields.push_back(lite::string_view(text[i].data(), text[i].size()));
+        }
+        std::vector<T> out(count);
+
+        double lite_rate = gb_per_s(count, [&] {
+            T sum = T();
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                sum += std::is_integral<T>::value
+                    ? static_cast<T>(lite::parse_int<long long>(fields[i]).value)
+                    : static_cast<T>(lite::parse_float<double>(fields[i]).value);
+            }
+            return static_cast<std::size_t>(sum);
+        });
+        double batch_rate = gb_per_s(count, [&] {
+            return std::is_integral<T>::value
+                ? lite::parse_int_batch(&fields[0], count, reinterpret_cast<long long*>(&out[0]))
+                : lite::parse_float_batch(&fields[0], count, reinterpret_cast<double*>(&out[0]));
+        });
+        double std_rate = gb_per_s(count, [&] {
+            T sum = T();
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                T value = T();
+                std::from_chars(text[i].data(), text[i].data() + text[i].size(), value);
+                sum += value;
+            }
+            return static_cast<std::size_t>(sum);
+        });
+
+        std::printf("%10s %12.1f %12.1f %12.1f\n", name, lite_rate * 1e3, batch_rate * 1e3, std_rate * 1e3);
+    }
+
+    // 並行查找隨線程數的擴展：目標都不存在，整個緩衝區都要掃描
+    void parallel_scan(std::size_t size, unsigned threads)
+    {
+        std::string text(size, 'a');
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            text[i] = static_cast<char>('a' + (i * 7 + i / 13) % 16);
+        }
+        const lite::string_view sv(text.data(), text.size());
+
+        lite::parallel::thread_pool pool(threads);
+        lite::parallel::options o;
+        o.pool = &pool;
+        double find = gb_per_s(size, [&] { return lite::parallel::find(sv, "needle", 0, o); });
+        double count = gb_per_s(size, [&] { return lite::parallel::count(sv, "ab", o); });
+        double ffo = gb_per_s(size, [&] { return lite::parallel::find_first_of(sv, "xyz,", 0, o); });
+        double serial = gb_per_s(size, [&] { return sv.find("needle"); });
+
+        std::printf("%10zu %8u %12.2f %12.2f %12.2f %12.2f\n", size, threads, find, count, ffo, serial);
+    }
+}
+
+// string_view_bench [--json] [--filter text] [--min-time seconds] [--max-bytes n]
+// 先逐個成員對比lite和std，--json時以JSON輸出這部分後結束；
+// 不帶參數時再運行各個專題的表格（memchr、char_set、散列、UTF-8、並行查找等）
+int main(int argc, char* argv[])
+{
+    bench::options options;
+    bool json = false;
+    if (!bench::parse_args(argc, argv, options, json))
+    {
+        std::fprintf(stderr, "usage: %s [--json] [--filter text] [--min-time seconds] [--max-bytes n]\n", argv[0]);
+        return 2;
+    }
+
+    if (json)
+    {
+        bench::suite suite(options, NULLPTR, NULLPTR);
+        suite.run();
+        bench::write_json(stdout, suite.results(), options);
+        return 0;
+    }
+
+    bench::print_header();
+    bench::suite suite(options, bench::print_row, NULLPTR);
+    suite.run();
+    if (argc > 1) return 0;
+
+    std::printf("\n");
+    std::printf("%10s %12s %12s %12s %12s %12s\n",
+        "bytes", "lite::find", "std::find", "memchr", "lite::rfind", "std::rfind");
+    for (std::size_t size = 16; size <= (std::size_t(1) << 24); size *= 4)
+    {
+        find_char(size);
+    }
+
+    std::printf("\n%10s %8s %12s %12s %12s %12s\n",
+        "bytes", "needle", "lite::find", "std::find", "lite::rfind", "std::rfind");
+    for (std::size_t needle_size = 2; needle_size <= 1024; needle_size *= 2)
+    {
+        find_substring(std::size_t(1) << 16, needle_size);
+    }
+
+    std::printf("\n%10s %12s %12s %12s\n", "bytes", "lite::ffo", "char_set", "std::ffo");
+    for (std::size_t size = 64; size <= (std::size_t(1) << 20); size *= 16)
+    {
+        find_first_of(size);
+    }
+
+    std::printf("\n%10s %12s %12s\n", "key bytes", "lite::hash", "std::hash");
+    for (std::size_t key_size = 8; key_size <= 64; key_size *= 2)
+    {
+        hash_keys(key_size);
+    }
+
+    std::printf("\n%10s %12s %12s\n", "key bytes", "lite::==", "std::==");
+    for (std::size_t key_size = 4; key_size <= 64; key_size *= 2)
+    {
+        equal_keys(key_size);
+    }
+
+    std::printf("\n%10s %12s %12s %12s\n", "bytes", "lite::ifind", "to_lower+find", "tolower+find");
+    for (std::size_t size = 64; size <= (std::size_t(1) << 20); size *= 16)
+    {
+        ifind_text(size);
+    }
+
+    std::printf("\n%10s %8s %12s %12s %12s\n", "bytes", "algo", "begin/end", "legacy iter", "raw pointer");
+    for (std::size_t size = 64; size <= (std::size_t(1) << 20); size *= 128)
+    {
+        iterator_algorithms(size);
+    }
+
+    std::printf("\n%10s %8s %13s %13s %13s %13s %13s\n", "bytes", "CharT", "find char", "find", "compare", "find_first_of", "hash");
+    for (std::size_t size = 256; size <= (std::size_t(1) << 20); size *= 64)
+    {
+        wide_members<char16_t>("char16_t", size);
+        wide_members<char32_t>("char32_t", size);
+        wide_members<wchar_t>("wchar_t", size);
+    }
+
+    std::printf("\n%10s %6s %12s %12s %12s %12s\n", "bytes", "text", "validate", "valid_prefix", "count", "to_utf16");
+    for (std::size_t size = 64; size <= (std::size_t(1) << 20); size *= 16)
+    {
+        utf8_text(size, true);
+        utf8_text(size, false);
+    }
+
+    std::printf("\n%10s %12s %12s %12s  (Mvalues/s)\n", "numbers", "lite::parse", "lite::batch", "from_chars");
+    parse_numbers<long long>("int", "%lld", 1.0);
+    parse_numbers<long long>("int19", "%lld", 9.2e9);
+    parse_numbers<double>("double", "%.17g", 1.2345e-3);
+    parse_numbers<double>("fixed", "%.3f", 1e-4);
+
+    std::printf("\n%10s %8s %12s %12s %12s %12s\n", "bytes", "threads", "par::find", "par::count", "par::ffo", "find");
+    const unsigned hardware = std::thread::hardware_concurrency();
+    for (unsigned threads = 1; threads <= (hardware > 0 ? hardware : 1); threads *= 2)
+    {
+        parallel_scan(std::size_t(1) << 28, threads);
+    }
+    return 0;
+}
@@ -0,0 +1,277 @@
+#include "bench_suite.hpp"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <set>
+#include <string>
+#include <string_view>
+#if defined(__linux__)
+#  include <sched.h> // sched_setaffinity
+#endif
+
+// 性能回歸檢查：運行固定的一組測量（只測lite），與倉庫裏的基線JSON比較，
+// 有測量變慢超過閾值時返回1。基線與機器有關，換機器或編譯器後用--write-baseline重新生成。
+//
+//   string_view_perfcheck [--baseline FILE] [--write-baseline FILE] [--threshold 0.10] [--noise 3]
+//                         [--cpu N] [--repetitions 7] [--min-time 0.005] [--filter S] [--verbose]
+//                         [--allow-mismatch]
+//
+// 基線context裏的編譯器或SIMD級別與當前構建不同時拒絕比較（返回2），
+// 加--allow-mismatch時只給出警告。基線裏有、這次沒有運行的測量會逐個列出。
+//
+// 每次重複是完整的一輪，一段時間內的干擾只影響每個測量的一個樣本。
+// 判斷回歸用中位數和MAD（中位數絕對偏差）：中位數比基線慢threshold以上，
+// 並且差值超過兩邊MAD之和的noise倍，才算回歸；只滿足其一的算作噪聲。
+namespace
+{
+    struct config
+    {
+        std::string baseline = "perf/baseline.json";
+        std::string write_baseline;
+        double threshold = 0.10;
+        double noise = 3.0;
+        int cpu = -1;
+        bool verbose = false;
+        bool allow_mismatch = false;
+    };
+
+    struct entry
+    {
+        double ns;
+        double mad;
+    };
+
+    struct baseline_file
+    {
+        std::string compiler;
+        std::string simd;
+        std::map<std::string, entry> entries;
+    };
+
+    // 把進程綁到一個CPU上，cpu爲-1時用當前允許的第一個。返回實際的CPU，失敗時返回-1
+    int pin_cpu(int cpu)
+    {
+#if defined(__linux__)
+        cpu_set_t allowed;
+        CPU_ZERO(&allowed);
+        if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) return -1;
+        if (cpu < 0)
+        {
+            for (int i = 0; i < CPU_SETSIZE; ++i)
+            {
+                if (CPU_ISSET(i, &allowed))
+                {
+                    cpu = i;
+                    break;
+                }
+            }
+        }
+        if (cpu < 0 || cpu >= CPU_SETSIZE) return -1;
+        cpu_set_t one;
+        CPU_ZERO(&one);
+        CPU_SET(cpu, &one);
+        return sched_setaffinity(0, sizeof(one), &one) == 0 ? cpu : -1;
+#else
+        (void)cpu;
+        return -1;
+#endif
+    }
+
+    // 行中"key": 之後的字符串或數字，沒有時返回空
+    std::string field(const std::string& line, const char* key)
+    {
+        const std::string k = std::string("\"") + key + "\": ";
+        std::string::size_type i = line.find(k);
+        if (i == std::string::npos) return std::string();
+        i += k.size();
+        if (i < line.size() && line[i] == '"')
+        {
+            std::string::size_type e = line.find('"', i + 1);
+            return e == std::string::npos ? std::string() : line.substr(i + 1, e - i - 1);
+        }
+        std::string::size_type e = line.find_first_of(",}", i);
+        return line.substr(i, e == std::string::npos ? std::string::npos : e - i);
+    }
+
+    // 讀bench::write_json寫出的文件：context的每個字段和每個結果各佔一行
+    bool load_baseline(const std::string& path, baseline_file& out)
+    {
+        std::FILE* f = std::fopen(path.c_str(), "r");
+        if (f == NULLPTR) return false;
+        std::string line;
+        char buf[1024];
+        while (std::fgets(buf, sizeof(buf), f) != NULLPTR)
+        {
+            line += buf;
+            if (line.empty() || line[line.size() - 1] != '\n') continue;
+            if (field(line, "impl") == "lite")
+            {
+                entry e;
+                e.ns = std::atof(field(line, "ns").c_str());
+                e.mad = std::atof(field(line, "mad").c_str());
+                out.entries[field(line, "name")] = e;
+            }
+            else if (out.compiler.empty() && line.find("\"compiler\": ") != std::string::npos)
+            {
+                out.compiler = field(line, "compiler");
+            }
+            else if (out.simd.empty() && line.find("\"simd\": ") != std::string::npos)
+            {
+                out.simd = field(line, "simd");
+            }
+            line.clear();
+        }
+        std::fclose(f);
+        return true;
+    }
+
+    bool parse_args(int argc, char* argv[], config& c, bench::options& o)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string_view arg(argv[i]);
+            bool value = i + 1 < argc;
+            if (arg == "--baseline" && value) c.baseline = argv[++i];
+            else if (arg == "--write-baseline" && value) c.write_baseline = argv[++i];
+            else if (arg == "--threshold" && value) c.threshold = std::atof(argv[++i]);
+            else if (arg == "--noise" && value) c.noise = std::atof(argv[++i]);
+            else if (arg == "--cpu" && value) c.cpu = std::atoi(argv[++i]);
+            else if (arg == "--repetitions" && value) o.repetitions = static_cast<std::size_t>(std::atoi(argv[++i]));
+            else if (arg == "--min-time" && value) o.min_time = std::atof(argv[++i]);
+            else if (arg == "--filter" && value) o.filter = argv[++i];
+            else if (arg == "--verbose") c.verbose = true;
+            else if (arg == "--allow-mismatch") c.allow_mismatch = true;
+            else return false;
+        }
+        return o.repetitions > 0;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    config c;
+    bench::options o;
+    o.sizes = { 64, 4096, std::size_t(1) << 20 };
+    o.repetitions = 7;
+    o.min_time = 0.005;
+    o.warmup = true;
+    o.with_std = false;
+    if (!parse_args(argc, argv, c, o))
+    {
+        std::fprintf(stderr,
+                     "usage: %s [--baseline FILE] [--write-baseline FILE] [--threshold 0.10] [--noise 3]\n"
+                     "          [--cpu N] [--repetitions 7] [--min-time 0.005] [--filter S] [--verbose]\n"
+                     "          [--allow-mismatch]\n",
+                     argv[0]);
+        return 2;
+    }
+
+    baseline_file baseline;
+    if (c.write_baseline.empty())
+    {
+        if (!load_baseline(c.baseline, baseline))
+        {
+            std::fprintf(stderr, "cannot read baseline %s\n", c.baseline.c_str());
+            return 2;
+        }
+        // 不同編譯器或SIMD級別的數字不可比，默認拒絕
+        const bool same_compiler = baseline.compiler == bench::compiler_name();
+        const bool same_simd = baseline.simd == bench::simd_name();
+        if (!same_compiler || !same_simd)
+        {
+            std::fprintf(stderr, "%s: baseline was built with %s/%s, this build is %s/%s\n",
+                         c.allow_mismatch ? "warning" : "error",
+                         baseline.compiler.empty() ? "?" : baseline.compiler.c_str(),
+                         baseline.simd.empty() ? "?" : baseline.simd.c_str(),
+                         bench::compiler_name(), bench::simd_name());
+            if (!c.allow_mismatch)
+            {
+                std::fprintf(stderr, "regenerate it with --write-baseline, or pass --allow-mismatch to compare anyway\n");
+                return 2;
+            }
+        }
+    }
+
+    const int cpu = pin_cpu(c.cpu);
+    if (cpu < 0) std::fprintf(stderr, "warning: could not pin to a CPU, results may be noisy\n");
+    else std::printf("pinned to cpu %d, %zu repetitions of %g s\n", cpu, o.repetitions, o.min_time);
+
+    std::vector<bench::result> results;
+    for (std::size_t pass = 0; pass < o.repetitions; ++pass)
+    {
+        bench::options once(o);
+        once.repetitions = 1;
+        once.warmup = o.warmup && pass == 0;
+        bench::suite suite(once, NULLPTR, NULLPTR);
+        suite.run();
+        if (pass == 0) results = suite.results();
+        else for (std::size_t i = 0; i < results.size(); ++i) results[i].samples.push_back(suite.results()[i].samples[0]);
+    }
+    for (std::size_t i = 0; i < results.size(); ++i) bench::summarize(results[i]);
+
+    if (!c.write_baseline.empty())
+    {
+        std::FILE* f = std::fopen(c.write_baseline.c_str(), "w");
+        if (f == NULLPTR)
+        {
+            std::fprintf(stderr, "cannot write baseline %s\n", c.write_baseline.c_str());
+            return 2;
+        }
+        bench::write_json(f, results, o);
+        std::fclose(f);
+        std::printf("wrote %zu results to %s\n", results.size(), c.write_baseline.c_str());
+        return 0;
+    }
+
+    std::size_t regressed = 0;
+    std::size_t improved = 0;
+    std::size_t missing = 0;
+    std::printf("%-44s %12s %12s %10s %10s %8s  %s\n", "name", "base ns", "ns", "mad", "GB/s", "change", "status");
+    for (std::size_t i = 0; i < results.size(); ++i)
+    {
+        const bench::result& r = results[i];
+        std::map<std::string, entry>::const_iterator b = baseline.entries.find(r.name);
+        if (b == baseline.entries.end())
+        {
+            ++missing;
+            if (c.verbose) std::printf("%-44s %12s %12.2f %10.2f %10.3f %8s  new\n", r.name.c_str(), "-", r.ns, r.mad, r.gbps, "-");
+            continue;
+        }
+
+        const double base = b->second.ns;
+        const double change = base > 0 ? r.ns / base - 1 : 0;
+        const bool significant = std::abs(r.ns - base) > c.noise * (r.mad + b->second.mad);
+        const char* status = "ok";
+        if (significant && change > c.threshold)
+        {
+            status = "REGRESSED";
+            ++regressed;
+        }
+        else if (significant && change < -c.threshold)
+        {
+            status = "faster";
+            ++improved;
+        }
+        if (c.verbose || status[0] != 'o')
+        {
+            std::printf("%-44s %12.2f %12.2f %10.2f %10.3f %+7.1f%%  %s\n", r.name.c_str(), base, r.ns, r.mad, r.gbps, change * 100, status);
+        }
+    }
+
+    // 基線裏有、這次沒有運行的測量：改名或刪掉後應該重新生成基線
+    std::set<std::string> ran;
+    for (std::size_t i = 0; i < results.size(); ++i) ran.insert(results[i].name);
+    std::size_t gone = 0;
+    for (std::map<std::string, entry>::const_iterator b = baseline.entries.begin(); b != baseline.entries.end(); ++b)
+    {
+        if (ran.count(b->first) != 0 || b->first.find(o.filter) == std::string::npos) continue;
+        ++gone;
+        std::printf("%-44s %12.2f %12s %10s %10s %8s  not run\n", b->first.c_str(), b->second.ns, "-", "-", "-", "-");
+    }
+
+    std::printf("%zu benchmarks, %zu regressed, %zu faster, %zu not in baseline, %zu in baseline but not run "
+                "(threshold %.0f%%, noise %g x MAD)\n",
+                results.size(), regressed, improved, missing, gone, c.threshold * 100, c.noise);
+    return regressed == 0 ? 0 : 1;
+}